@@ -0,0 +1,74 @@
+/**
+  * benchmark_circularBuffer_scrub.c : En-queue/De-queue throughput of circular buffer for each scrub policy.
+  *
+  * Build : gcc -O2 benchmark_circularBuffer_scrub.c circularBuffer.c -o benchmark_circularBuffer_scrub
+  */
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "circularBuffer.h"
+
+#define     BLOCKSIZE_PER_CALL      256
+#define     TOTAL_ELEMENTS          (64*1024*1024)      //elements moved per measurement
+
+static const int32_t    ringLength[]  = {2048, 64*1024, 16*1024*1024};
+static const uint8_t    scrubPolicy[] = {BUF_SCRUB_NONE, BUF_SCRUB_ZERO, BUF_SCRUB_SECURE};
+static const char       *scrubName[]  = {"none", "zero", "secure"};
+
+_RING_BUFFER_DATA_TYPE  blockIn[BLOCKSIZE_PER_CALL];
+_RING_BUFFER_DATA_TYPE  blockOut[BLOCKSIZE_PER_CALL];
+
+static double now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec*1e-9;
+}
+
+int main()
+{
+    circularBuffer_TypeDef  myRingBuffer;
+    _RING_BUFFER_DATA_TYPE  *p_myBuffer;
+    uint32_t                moved;
+    uint32_t                i, j, k;
+    double                  t0, t1;
+
+    for(i=0; i<BLOCKSIZE_PER_CALL; i++)     blockIn[i] = i;
+
+    printf("ring length\tscrub\tMB/s (en-queue + de-queue payload)\n");
+    for(i=0; i<sizeof(ringLength)/sizeof(ringLength[0]); i++)
+    {
+        p_myBuffer = malloc(ringLength[i]*sizeof(_RING_BUFFER_DATA_TYPE));
+        if(p_myBuffer == NULL)      return 1;
+
+        for(j=0; j<sizeof(scrubPolicy)/sizeof(scrubPolicy[0]); j++)
+        {
+            CircularBuffer_InitPow2(&myRingBuffer, p_myBuffer, sizeof(_RING_BUFFER_DATA_TYPE), ringLength[i]);
+            CircularBuffer_SetScrubPolicy(&myRingBuffer, scrubPolicy[j]);
+
+            /* Fill the ring up to full, then drain it, so each pass streams over the whole capacity */
+            t0 = now();
+            for(moved=0; moved<TOTAL_ELEMENTS; )
+            {
+                for(k=0; k<(uint32_t)ringLength[i]; k+=BLOCKSIZE_PER_CALL)
+                {
+                    CircularBuffer_Enqueue(&myRingBuffer, blockIn, BLOCKSIZE_PER_CALL);
+                }
+                for(k=0; k<(uint32_t)ringLength[i]; k+=BLOCKSIZE_PER_CALL)
+                {
+                    CircularBuffer_Dequeue(&myRingBuffer, blockOut, BLOCKSIZE_PER_CALL);
+                }
+                moved += ringLength[i];
+            }
+            t1 = now();
+
+            printf("%d\t\t%s\t%.1f\n", ringLength[i], scrubName[j],
+                   2.0*moved*sizeof(_RING_BUFFER_DATA_TYPE)/(t1 - t0)/1e6);
+        }
+        free(p_myBuffer);
+    }
+    return 0;
+}
@@ -0,0 +1,161 @@
+/**
+  * benchmark_circularBuffer_spsc.c : Two-thread throughput of SPSC circular buffer at several transfer sizes, with and without waiters.
+  *
+  * Build : gcc -O2 -pthread benchmark_circularBuffer_spsc.c circularBuffer_spsc.c circularBuffer_wait.c -o benchmark_circularBuffer_spsc
+  *         gcc -O2 -pthread -DCIRCULAR_BUFFER_SPSC_NO_INDEX_CACHE benchmark_circularBuffer_spsc.c circularBuffer_spsc.c circularBuffer_wait.c \
+  *             -o benchmark_circularBuffer_spsc_nocache
+  *
+  *         Run both binaries to compare the cached opposite index against reloading it on every call.
+  *         Producer and consumer are pinned to CPU 0 and CPU 1 (Linux), pass 2 other CPU numbers as arguments to change them.
+  *         Each transfer size is measured twice, by how a thread which finds the ring full/empty waits :
+  *           - polling : sched_yield() and retry, no waiter is ever attached, Notify costs its fence and 1 relaxed load
+  *           - parking : CircularBufferSPSC_WaitForSpace()/WaitForData(), the other thread also pays the futex wake ups
+  *         In the polling column, the gap between 1 and 16 elements/call shows how far the per-call fence of Notify is amortized.
+  *         Both modes also run on a single CPU, but the cache line traffic is only visible on 2 cores.
+  */
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+#include "circularBuffer_spsc.h"
+
+#define     RING_LENGTH             1024
+#define     TOTAL_ELEMENTS          (16*1024*1024)      //elements moved per measurement
+
+static const uint32_t   blockSize[] = {1, 16, 256};
+
+typedef struct {
+
+    circularBufferSPSC_TypeDef  *ring;
+    uint32_t                    blockSize;
+    uint8_t                     park;           //1 -> wait with CircularBufferSPSC_Wait*(), 0 -> sched_yield()
+    int                         cpu;
+    uint64_t                    checksum;
+
+} benchThread_TypeDef;
+
+static circularBufferSPSC_TypeDef   myRingBuffer;
+static _RING_BUFFER_DATA_TYPE       ringStorage[RING_LENGTH];
+
+static double now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec*1e-9;
+}
+
+static void pinThread(int cpu)
+{
+#if defined(__linux__)
+    cpu_set_t set;
+
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);      //best effort
+#else
+    (void)cpu;
+#endif
+}
+
+static void *producer(void *arg)
+{
+    benchThread_TypeDef     *t = (benchThread_TypeDef *)arg;
+    _RING_BUFFER_DATA_TYPE  block[256];
+    uint32_t                sent = 0;
+    uint32_t                n, i;
+
+    pinThread(t->cpu);
+    while(sent < TOTAL_ELEMENTS)
+    {
+        for(i=0; i<t->blockSize; i++)   block[i] = sent + i;
+        i = 0;
+        while(i < t->blockSize)
+        {
+            n = CircularBufferSPSC_Enqueue(t->ring, block + i, t->blockSize - i);
+            if((n == 0) && t->park)     CircularBufferSPSC_WaitForSpace(t->ring, 1, -1);
+            else if(n == 0)             sched_yield();
+            i += n;
+        }
+        sent += t->blockSize;
+    }
+    return NULL;
+}
+
+static void *consumer(void *arg)
+{
+    benchThread_TypeDef     *t = (benchThread_TypeDef *)arg;
+    _RING_BUFFER_DATA_TYPE  block[256];
+    uint32_t                received = 0;
+    uint32_t                n, i;
+
+    pinThread(t->cpu);
+    while(received < TOTAL_ELEMENTS)
+    {
+        n = CircularBufferSPSC_Dequeue(t->ring, block, t->blockSize);
+        if((n == 0) && t->park)     CircularBufferSPSC_WaitForData(t->ring, 1, -1);
+        else if(n == 0)             sched_yield();
+        for(i=0; i<n; i++)      t->checksum += block[i];
+        received += n;
+    }
+    return NULL;
+}
+
+/* Move TOTAL_ELEMENTS from producer to consumer, retval Melements/s, negative -> data error */
+static double runBenchmark(uint32_t size, uint8_t park, int producerCpu, int consumerCpu)
+{
+    benchThread_TypeDef prod, cons;
+    pthread_t           prodThread, consThread;
+    uint64_t            expected = (uint64_t)TOTAL_ELEMENTS*(TOTAL_ELEMENTS - 1)/2;
+    double              t0, t1;
+
+    CircularBufferSPSC_Init(&myRingBuffer, ringStorage, sizeof(_RING_BUFFER_DATA_TYPE), RING_LENGTH);
+    prod.ring = &myRingBuffer;
+    prod.blockSize = size;
+    prod.park = park;
+    prod.cpu = producerCpu;
+    prod.checksum = 0;
+    cons = prod;
+    cons.cpu = consumerCpu;
+
+    t0 = now();
+    pthread_create(&consThread, NULL, consumer, &cons);
+    pthread_create(&prodThread, NULL, producer, &prod);
+    pthread_join(prodThread, NULL);
+    pthread_join(consThread, NULL);
+    t1 = now();
+
+    /* int32_t elements wrap, compare the sum modulo 2^32 */
+    if((uint32_t)cons.checksum != (uint32_t)expected)   return -1.0;
+    return TOTAL_ELEMENTS/(t1 - t0)/1e6;
+}
+
+int main(int argc, char *argv[])
+{
+    int         producerCpu = (argc > 2) ? atoi(argv[1]) : 0;
+    int         consumerCpu = (argc > 2) ? atoi(argv[2]) : 1;
+    double      polling, parking;
+    uint32_t    i;
+
+#if defined(CIRCULAR_BUFFER_SPSC_NO_INDEX_CACHE)
+    printf("opposite index : reloaded on every call\n");
+#else
+    printf("opposite index : cached\n");
+#endif
+    printf("elements/call\tMelements/s polling (no waiter)\tMelements/s parking (waiters)\n");
+    for(i=0; i<sizeof(blockSize)/sizeof(blockSize[0]); i++)
+    {
+        polling = runBenchmark(blockSize[i], 0, producerCpu, consumerCpu);
+        parking = runBenchmark(blockSize[i], 1, producerCpu, consumerCpu);
+        if((polling < 0) || (parking < 0))
+        {
+            printf("data error at %u elements/call\n", blockSize[i]);
+            return 1;
+        }
+        printf("%u\t\t%.1f\t\t\t\t%.1f\n", blockSize[i], polling, parking);
+    }
+    return 0;
+}
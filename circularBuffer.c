@@ -15,15 +15,49 @@
       1) To En-queue a FIFO circular buffer,    call the function CircularBuffer_Enqueue()
       2) To De-queue a FIFO circular buffer,    call the function CircularBuffer_Dequeue()
       3) To initialize a FIFO circular buffer,  call the function CircularBuffer_Init()
+         or, for a power-of-two capacity,     call the function CircularBuffer_InitPow2()
+
+    + To En-queue without a staging array (zero-copy), call CircularBuffer_Reserve() to get the writable region,
+      write data into it, then call CircularBuffer_Commit() with number of written elements.
+    + To De-queue without copying out (zero-copy), call CircularBuffer_Peek() to get the readable region,
+      read data in place, then call CircularBuffer_Consume() with number of read elements.
+    + To read without de-queueing (e.g. features of the last N samples, pre-trigger history), call CircularBuffer_PeekAt(),
+      CircularBuffer_PeekAtRear() or CircularBuffer_CopyLast(). They do not modify front, so the consumer is not disturbed.
+    + To count traffic and data loss of a buffer (overruns, underruns, high-water mark), register counters with
+      CircularBuffer_SetStats() and read them, from any thread, with CircularBuffer_GetStats().
+    + To measure how long elements wait before their frame is extracted, build with -DCIRCULAR_BUFFER_LATENCY
+      (see circularBuffer_latency.c).
+    + En-queue, de-queue, overwrite and drop have USDT probes for perf/bpftrace (see circularBuffer_trace.h).
+    + To grow or shrink a buffer without losing its content, call CircularBuffer_Resize() with a new storage array.
+
+    + A buffer initialized by CircularBuffer_InitPow2() wraps its indices with a mask instead of modulo,
+      and keeps 64-bit positions rPos,fPos instead of r,f. There is no empty/full state machine in this mode,
+      number of elements is always (rPos - fPos). Use CircularBuffer_GetCount() instead of reading r,f directly.
 **/
 
 #include "circularBuffer.h"
+#include "circularBuffer_latency.h"
+#include "circularBuffer_trace.h"
+#include "circularBuffer_persist.h"
+
+#if defined(CIRCULAR_BUFFER_TRACE_SDT)
+/* USDT semaphores of all probes (also of dsp_frame.c), in section ".probes" where the tracer finds them */
+#define     CIRCULAR_BUFFER_TRACE_SEMAPHORE_DEF(probe) \
+    volatile unsigned short CIRCULAR_BUFFER_TRACE_SEMAPHORE(probe) __attribute__((unused, section(".probes")))
+
+CIRCULAR_BUFFER_TRACE_SEMAPHORE_DEF(enqueue);
+CIRCULAR_BUFFER_TRACE_SEMAPHORE_DEF(dequeue);
+CIRCULAR_BUFFER_TRACE_SEMAPHORE_DEF(overwrite);
+CIRCULAR_BUFFER_TRACE_SEMAPHORE_DEF(drop);
+CIRCULAR_BUFFER_TRACE_SEMAPHORE_DEF(first_frame);
+CIRCULAR_BUFFER_TRACE_SEMAPHORE_DEF(frame_ready);
+#endif
 
 
 /**
   * @brief  CircularBuffer_Init() : This function is used to "initialize" a FIFO circular buffer struct.
   * @param  targetBuf     : target circular buffer
-  * @param  pBuf          : pointer of storage buffer array
+  * @param  pBuf          : pointer of storage buffer array, NULL -> storage is attached later and keeps its content (see circularBuffer_persist.h)
   * @param  SetElementSize : size of each element (bytes)
   * @param  SetBufferSize  : size of buffer (elements)
   * @retval None
@@ -37,8 +71,189 @@ void CircularBuffer_Init(circularBuffer_TypeDef *targetBuf, void *pBuf, int8_t S
     targetBuf->elementSize = SetElementSize;
     targetBuf->f = -1;
     targetBuf->r = -1;
+    targetBuf->mode = BUF_MODE_DEFAULT;
+    targetBuf->rPos = 0;
+    targetBuf->fPos = 0;
+    targetBuf->mirrored = 0;
+    targetBuf->allocPage = 0;
+    targetBuf->persistent = 0;
+    targetBuf->persistHeader = NULL;
+    targetBuf->scrubPolicy = BUF_SCRUB_ZERO;
+    targetBuf->overflowPolicy = BUF_OVERFLOW_PARTIAL;
+    targetBuf->event = NULL;
+    targetBuf->watermark = NULL;
+    targetBuf->stats = NULL;
+#if defined(CIRCULAR_BUFFER_LATENCY)
+    targetBuf->latency = NULL;
+#endif
     InputByteSize = (targetBuf->elementSize)*(targetBuf->bufferSize);
-    memset(targetBuf->buf, 0, InputByteSize);
+    if(targetBuf->buf != NULL)      memset(targetBuf->buf, 0, InputByteSize);
+}
+
+/**
+  * @brief  CircularBuffer_InitPow2() : This function is used to "initialize" a FIFO circular buffer struct with power-of-two capacity.
+  *                                     Index wrapping is done by mask and element offset by shift, instead of modulo and multiply.
+  * @param  targetBuf     : target circular buffer
+  * @param  pBuf          : pointer of storage buffer array, NULL -> attached later (see CircularBuffer_Init())
+  * @param  SetElementSize : size of each element (bytes), must be a power of two
+  * @param  SetBufferSize  : size of buffer (elements), must be a power of two
+  * @retval 0 -> success
+  *         1 -> error, element size or buffer size is not a power of two
+  */
+uint8_t CircularBuffer_InitPow2(circularBuffer_TypeDef *targetBuf, void *pBuf, int8_t SetElementSize, int32_t SetBufferSize)
+{
+    uint8_t shift;
+
+    if((SetBufferSize <= 0) || ((SetBufferSize & (SetBufferSize - 1)) != 0))     return 1;
+    if((SetElementSize <= 0) || ((SetElementSize & (SetElementSize - 1)) != 0))  return 1;
+
+    for(shift=0; (1 << shift) < SetElementSize; shift++);
+
+    CircularBuffer_Init(targetBuf, pBuf, SetElementSize, SetBufferSize);
+    targetBuf->mode = BUF_MODE_POW2;
+    targetBuf->elementShift = shift;
+    targetBuf->mask = (uint32_t)SetBufferSize - 1;
+    return 0;
+}
+
+/**
+  * @brief  CircularBuffer_SetScrubPolicy() : This function is used to select how de-queued data is cleared in a circular buffer.
+  *                                          Call it right after CircularBuffer_Init(), default policy is BUF_SCRUB_ZERO.
+  * @param  targetBuf : target circular buffer
+  * @param  policy    : BUF_SCRUB_NONE   -> de-queued data is left in buffer (no extra memory traffic)
+  *                     BUF_SCRUB_ZERO   -> de-queued data is cleared by memset()
+  *                     BUF_SCRUB_SECURE -> de-queued data is cleared by a memset() which is never optimized out,
+  *                                         also applied by CircularBuffer_Consume()
+  * @retval None
+  */
+void CircularBuffer_SetScrubPolicy(circularBuffer_TypeDef *targetBuf, uint8_t policy)
+{
+    targetBuf->scrubPolicy = policy;
+}
+
+/**
+  * @brief  CircularBuffer_SetOverflowPolicy() : This function is used to select what CircularBuffer_Enqueue() does when data does not fit.
+  *                                             Default policy is BUF_OVERFLOW_PARTIAL.
+  * @param  targetBuf : target circular buffer
+  * @param  policy    : BUF_OVERFLOW_REJECT    -> nothing is en-queued, return 0
+  *                     BUF_OVERFLOW_PARTIAL   -> only the elements which fit are en-queued, the rest is dropped
+  *                     BUF_OVERFLOW_OVERWRITE -> the oldest elements in buffer are dropped to make space
+  *                     BUF_OVERFLOW_BLOCK     -> for lock-free buffers only (see CircularBufferSPSC_SetOverflowPolicy()),
+  *                                               there is no concurrent consumer to wait for, so it works as BUF_OVERFLOW_PARTIAL
+  * @retval None
+  */
+void CircularBuffer_SetOverflowPolicy(circularBuffer_TypeDef *targetBuf, uint8_t policy)
+{
+    targetBuf->overflowPolicy = policy;
+}
+
+/**
+  * @brief  CircularBuffer_CheckWatermark() : Call the watermark callbacks when number of elements crosses a level, with hysteresis.
+  *                                          onHigh() and onLow() are called alternately, starting with onHigh().
+  */
+static void CircularBuffer_CheckWatermark(circularBuffer_TypeDef *targetBuf)
+{
+    circularBufferWatermark_TypeDef *watermark = targetBuf->watermark;
+    uint32_t                        count = CircularBuffer_GetCount(targetBuf);
+
+    if(!watermark->isHigh && (count >= watermark->highLevel))
+    {
+        watermark->isHigh = 1;
+        if(watermark->onHigh != NULL)   watermark->onHigh(watermark->userData, count);
+    }
+    else if(watermark->isHigh && (count <= watermark->lowLevel))
+    {
+        watermark->isHigh = 0;
+        if(watermark->onLow != NULL)    watermark->onLow(watermark->userData, count);
+    }
+}
+
+/**
+  * @brief  CircularBuffer_SetWatermark() : This function is used to register high/low watermark callbacks of a circular buffer.
+  *                                        Callbacks are called from inside en-queue/de-queue functions (and Flush()), so they
+  *                                        must not en-queue or de-queue on the same buffer.
+  *                                        If buffer is already at highLevel, onHigh() is called before return.
+  * @param  targetBuf : target circular buffer
+  * @param  watermark : levels and callbacks, must stay valid while it is registered, NULL -> remove callbacks
+  * @retval 0 -> success
+  *         1 -> error, lowLevel must be less than highLevel
+  */
+uint8_t CircularBuffer_SetWatermark(circularBuffer_TypeDef *targetBuf, circularBufferWatermark_TypeDef *watermark)
+{
+    if((watermark != NULL) && (watermark->lowLevel >= watermark->highLevel))     return 1;
+
+    targetBuf->watermark = watermark;
+    if(watermark != NULL)
+    {
+        watermark->isHigh = 0;
+        CircularBuffer_CheckWatermark(targetBuf);
+    }
+    return 0;
+}
+
+/**
+  * @brief  CircularBuffer_SetStats() : This function is used to register statistics counters of a circular buffer.
+  *                                     Counters are cleared here, then updated by en-queue/de-queue functions.
+  * @param  targetBuf : target circular buffer
+  * @param  stats     : counters, must stay valid while it is registered, NULL -> stop counting
+  * @retval None
+  */
+void CircularBuffer_SetStats(circularBuffer_TypeDef *targetBuf, circularBufferStats_TypeDef *stats)
+{
+    if(stats != NULL)
+    {
+        atomic_init(&stats->enqueued, 0);
+        atomic_init(&stats->dequeued, 0);
+        atomic_init(&stats->overrun, 0);
+        atomic_init(&stats->underrun, 0);
+        atomic_init(&stats->wraps, 0);
+        atomic_init(&stats->maxFill, CircularBuffer_GetCount(targetBuf));
+    }
+    targetBuf->stats = stats;
+}
+
+/**
+  * @brief  CircularBuffer_GetStats() : This function is used to read statistics counters of a circular buffer.
+  *                                     Can be called from another thread while buffer is in use. Each counter is read
+  *                                     atomically, but the snapshot as a whole may mix 2 consecutive calls of en-queue/de-queue.
+  * @param  targetBuf : target circular buffer
+  * @param  snapshot  : output copy of counters
+  * @retval 0 -> success
+  *         1 -> error, no counters are registered
+  */
+uint8_t CircularBuffer_GetStats(circularBuffer_TypeDef *targetBuf, circularBufferStatsSnapshot_TypeDef *snapshot)
+{
+    circularBufferStats_TypeDef *stats = targetBuf->stats;
+
+    if(stats == NULL)       return 1;
+
+    snapshot->enqueued = atomic_load_explicit(&stats->enqueued, memory_order_relaxed);
+    snapshot->dequeued = atomic_load_explicit(&stats->dequeued, memory_order_relaxed);
+    snapshot->overrun  = atomic_load_explicit(&stats->overrun,  memory_order_relaxed);
+    snapshot->underrun = atomic_load_explicit(&stats->underrun, memory_order_relaxed);
+    snapshot->wraps    = atomic_load_explicit(&stats->wraps,    memory_order_relaxed);
+    snapshot->maxFill  = atomic_load_explicit(&stats->maxFill,  memory_order_relaxed);
+    return 0;
+}
+
+/**
+  * @brief  CircularBuffer_PersistFront(), CircularBuffer_PersistRear() : Store fPos/rPos into the file header of a persistent buffer.
+  *                                     Each one is stored right after its data change (the signal fence keeps the compiler from
+  *                                     moving the store before the copy), so a crash of the process at any point leaves the
+  *                                     file with indices that match its data. fPos is moved before an overwrite, rPos after a write.
+  */
+static inline void CircularBuffer_PersistFront(circularBuffer_TypeDef *targetBuf)
+{
+    if(targetBuf->persistHeader == NULL)    return;
+    atomic_signal_fence(memory_order_release);
+    targetBuf->persistHeader->fPos = targetBuf->fPos;
+}
+
+static inline void CircularBuffer_PersistRear(circularBuffer_TypeDef *targetBuf)
+{
+    if(targetBuf->persistHeader == NULL)    return;
+    atomic_signal_fence(memory_order_release);
+    targetBuf->persistHeader->rPos = targetBuf->rPos;
 }
 
 /**
@@ -48,8 +263,11 @@ void CircularBuffer_Init(circularBuffer_TypeDef *targetBuf, void *pBuf, int8_t S
   */
 void CircularBuffer_Flush(circularBuffer_TypeDef *targetBuf)
 {
+    targetBuf->fPos = targetBuf->rPos;
+    CircularBuffer_PersistFront(targetBuf);
     targetBuf->f = -1;
     targetBuf->r = -1;
+    if(targetBuf->watermark != NULL)    CircularBuffer_CheckWatermark(targetBuf);
 }
 
 /**
@@ -60,6 +278,8 @@ void CircularBuffer_Flush(circularBuffer_TypeDef *targetBuf)
   */
 uint8_t CircularBuffer_IsFull(circularBuffer_TypeDef *targetBuf)
 {
+    if(targetBuf->mode == BUF_MODE_POW2)    return (targetBuf->rPos - targetBuf->fPos) == (uint64_t)targetBuf->bufferSize;
+
     if((targetBuf->f == targetBuf->r) && (targetBuf->f != -1))      return 1;
     else        return 0;
 }
@@ -72,218 +292,520 @@ uint8_t CircularBuffer_IsFull(circularBuffer_TypeDef *targetBuf)
   */
 uint8_t CircularBuffer_IsEmpty(circularBuffer_TypeDef *targetBuf)
 {
+    if(targetBuf->mode == BUF_MODE_POW2)    return targetBuf->rPos == targetBuf->fPos;
+
     if((targetBuf->r == -1) && (targetBuf->f == -1))      return 1;
     else        return 0;
 }
 
+/**
+  * @brief  CircularBuffer_GetCount() : This function is used to get the number of elements in a circular buffer.
+  * @param  targetBuf : target circular buffer
+  * @retval number of elements in buffer
+  */
+uint32_t CircularBuffer_GetCount(circularBuffer_TypeDef *targetBuf)
+{
+    if(targetBuf->mode == BUF_MODE_POW2)        return (uint32_t)(targetBuf->rPos - targetBuf->fPos);
+
+    if(CircularBuffer_IsEmpty(targetBuf))       return 0;
+    else if(CircularBuffer_IsFull(targetBuf))   return targetBuf->bufferSize;
+    else if(targetBuf->r > targetBuf->f)        return targetBuf->r - targetBuf->f;
+    else                                        return targetBuf->bufferSize - targetBuf->f + targetBuf->r;
+}
+
+/* memset() called through a volatile pointer, so the compiler cannot remove a wipe of memory which is not read anymore */
+static void *(*const volatile CircularBuffer_SecureMemset)(void *, int, size_t) = memset;
+
+/**
+  * @brief  CircularBuffer_Scrub() : Clear a de-queued region according to scrub policy of buffer.
+  */
+static inline void CircularBuffer_Scrub(circularBuffer_TypeDef *targetBuf, void *pRegion, uint32_t byteSize)
+{
+    if(targetBuf->scrubPolicy == BUF_SCRUB_ZERO)            memset(pRegion, 0, byteSize);
+    else if(targetBuf->scrubPolicy == BUF_SCRUB_SECURE)     CircularBuffer_SecureMemset(pRegion, 0, byteSize);
+}
+
+/**
+  * @brief  CircularBuffer_GetRearIndex() : Index in buf of the next element to be en-queued (both modes).
+  */
+static uint32_t CircularBuffer_GetRearIndex(circularBuffer_TypeDef *targetBuf)
+{
+    if(targetBuf->mode == BUF_MODE_POW2)    return (uint32_t)targetBuf->rPos & targetBuf->mask;
+    if(CircularBuffer_IsEmpty(targetBuf))   return 0;
+    return (uint32_t)targetBuf->r;
+}
+
+/**
+  * @brief  CircularBuffer_AdvanceRear() : Move rear by n elements (n <= free space), keeping r,f state of BUF_MODE_DEFAULT valid.
+  */
+static void CircularBuffer_AdvanceRear(circularBuffer_TypeDef *targetBuf, uint32_t n)
+{
+    if(targetBuf->mode == BUF_MODE_POW2)
+    {
+        targetBuf->rPos += n;
+        CircularBuffer_PersistRear(targetBuf);
+        return;
+    }
+    if(n == 0)      return;
+    if(CircularBuffer_IsEmpty(targetBuf))
+    {
+        targetBuf->f = 0;
+        targetBuf->r = 0;
+    }
+    targetBuf->r = (int32_t)(((uint32_t)targetBuf->r + n) % (uint32_t)targetBuf->bufferSize);
+}
+
+/**
+  * @brief  CircularBuffer_GetFrontIndex() : Index in buf of the next element to be de-queued (both modes).
+  */
+static uint32_t CircularBuffer_GetFrontIndex(circularBuffer_TypeDef *targetBuf)
+{
+    if(targetBuf->mode == BUF_MODE_POW2)    return (uint32_t)targetBuf->fPos & targetBuf->mask;
+    if(CircularBuffer_IsEmpty(targetBuf))   return 0;
+    return (uint32_t)targetBuf->f;
+}
+
+/**
+  * @brief  CircularBuffer_AdvanceFront() : Move front by n elements (n <= number of elements), keeping r,f state of BUF_MODE_DEFAULT valid.
+  */
+static void CircularBuffer_AdvanceFront(circularBuffer_TypeDef *targetBuf, uint32_t n)
+{
+    if(targetBuf->mode == BUF_MODE_POW2)
+    {
+        targetBuf->fPos += n;
+        CircularBuffer_PersistFront(targetBuf);
+        return;
+    }
+    if(n == 0)      return;
+    targetBuf->f = (int32_t)(((uint32_t)targetBuf->f + n) % (uint32_t)targetBuf->bufferSize);
+    if(targetBuf->f == targetBuf->r)
+    {
+        /* buffer is empty after de-queue, then set r,f to -1 */
+        targetBuf->f = -1;
+        targetBuf->r = -1;
+    }
+}
+
+/**
+  * @brief  CircularBuffer_GetSpans() : Describe n elements starting at index in buf as 1 or 2 contiguous spans.
+  *                                     A mirrored buffer always gives 1 span.
+  */
+static void CircularBuffer_GetSpans(circularBuffer_TypeDef *targetBuf, uint32_t index, uint32_t n, circularBufferSpan_TypeDef span[2])
+{
+    uint32_t firstSize = ((uint32_t)targetBuf->bufferSize << targetBuf->mirrored) - index;
+
+    if(firstSize > n)       firstSize = n;
+    span[0].data = (void *)((uint8_t *)(targetBuf->buf) + targetBuf->elementSize*index);
+    span[0].size = firstSize;
+    span[1].data = targetBuf->buf;
+    span[1].size = n - firstSize;
+}
+
+/**
+  * @brief  CircularBuffer_CheckEvent() : Signal the readiness notification when en-queue makes the number of elements cross its level.
+  *                                      prevCount is the number before en-queue, an overwrite of a full buffer does not cross it.
+  */
+static inline void CircularBuffer_CheckEvent(circularBuffer_TypeDef *targetBuf, uint32_t prevCount)
+{
+    uint32_t count;
+
+    if(targetBuf->event == NULL)    return;
+
+    count = CircularBuffer_GetCount(targetBuf);
+    if((count >= targetBuf->event->level) && (prevCount < targetBuf->event->level))
+    {
+        targetBuf->event->signal(targetBuf->event);
+    }
+}
+
+/**
+  * @brief  CircularBuffer_StatsAdd() : Add to a counter. Only one thread writes the counters, so a relaxed load and store
+  *                                     is enough (no locked instruction), readers still never see a torn value.
+  */
+static inline void CircularBuffer_StatsAdd(_Atomic uint64_t *counter, uint64_t n)
+{
+    atomic_store_explicit(counter, atomic_load_explicit(counter, memory_order_relaxed) + n, memory_order_relaxed);
+}
+
+/**
+  * @brief  CircularBuffer_CountEnqueue() : Update statistics after en-queue of addedSize elements, droppedSize elements were lost.
+  */
+static void CircularBuffer_CountEnqueue(circularBuffer_TypeDef *targetBuf, uint32_t addedSize, uint32_t droppedSize)
+{
+    circularBufferStats_TypeDef *stats = targetBuf->stats;
+    uint32_t                    count = CircularBuffer_GetCount(targetBuf);
+
+    CircularBuffer_StatsAdd(&stats->enqueued, addedSize);
+    if(droppedSize != 0)    CircularBuffer_StatsAdd(&stats->overrun, droppedSize);
+
+    /* Rear started at (index - addedSize), it reached end of buf only if the new index is below addedSize */
+    if((addedSize != 0) && (CircularBuffer_GetRearIndex(targetBuf) < addedSize))      CircularBuffer_StatsAdd(&stats->wraps, 1);
+
+    if(count > atomic_load_explicit(&stats->maxFill, memory_order_relaxed))
+    {
+        atomic_store_explicit(&stats->maxFill, count, memory_order_relaxed);
+    }
+}
+
+/**
+  * @brief  CircularBuffer_CountDequeue() : Update statistics after de-queue of removedSize elements out of requestSize.
+  */
+static void CircularBuffer_CountDequeue(circularBuffer_TypeDef *targetBuf, uint32_t removedSize, uint32_t requestSize)
+{
+    CircularBuffer_StatsAdd(&targetBuf->stats->dequeued, removedSize);
+    if(removedSize < requestSize)   CircularBuffer_StatsAdd(&targetBuf->stats->underrun, 1);
+}
+
+/**
+  * @brief  CircularBuffer_EnqueuePow2() : Copy for BUF_MODE_POW2, called by CircularBuffer_Enqueue().
+  * @param  targetBuf    : target circular buffer
+  * @param  enqueueData  : enqueued data pointer
+  * @param  enqueueSize  : size of enqueued data (#of element), must not exceed free space
+  * @retval None
+  */
+static void CircularBuffer_EnqueuePow2(circularBuffer_TypeDef *targetBuf, const void *enqueueData, uint32_t enqueueSize)
+{
+    uint32_t index     = (uint32_t)targetBuf->rPos & targetBuf->mask;
+    uint32_t firstSize = ((uint32_t)targetBuf->bufferSize << targetBuf->mirrored) - index;
+
+    if(firstSize > enqueueSize)     firstSize = enqueueSize;
+
+    /* 1st section (r to end-of-buffer), 2nd section is empty when not wrapping or when buffer is mirrored */
+    memcpy((void *)((uint8_t *)(targetBuf->buf) + (index << targetBuf->elementShift)), enqueueData, firstSize << targetBuf->elementShift);
+    memcpy(targetBuf->buf, (const void *)((const uint8_t *)(enqueueData) + (firstSize << targetBuf->elementShift)), (enqueueSize - firstSize) << targetBuf->elementShift);
+    targetBuf->rPos += enqueueSize;
+    CircularBuffer_PersistRear(targetBuf);
+}
+
+/**
+  * @brief  CircularBuffer_DequeuePow2() : Copy for BUF_MODE_POW2, called by CircularBuffer_Dequeue().
+  * @param  targetBuf    : target circular buffer
+  * @param  dequeueData  : dequeued data pointer
+  * @param  dequeueSize  : size of dequeued data (#of element), must not exceed number of elements
+  * @retval None
+  */
+static void CircularBuffer_DequeuePow2(circularBuffer_TypeDef *targetBuf, void *dequeueData, uint32_t dequeueSize)
+{
+    uint32_t index     = (uint32_t)targetBuf->fPos & targetBuf->mask;
+    uint32_t firstSize = ((uint32_t)targetBuf->bufferSize << targetBuf->mirrored) - index;
+    void     *pFirst   = (void *)((uint8_t *)(targetBuf->buf) + (index << targetBuf->elementShift));
+
+    if(firstSize > dequeueSize)     firstSize = dequeueSize;
+
+    /* 1st section (f to end-of-buffer), 2nd section is empty when not wrapping or when buffer is mirrored */
+    memcpy(dequeueData, pFirst, firstSize << targetBuf->elementShift);
+    CircularBuffer_Scrub(targetBuf, pFirst, firstSize << targetBuf->elementShift);
+    memcpy((void *)((uint8_t *)(dequeueData) + (firstSize << targetBuf->elementShift)), targetBuf->buf, (dequeueSize - firstSize) << targetBuf->elementShift);
+    CircularBuffer_Scrub(targetBuf, targetBuf->buf, (dequeueSize - firstSize) << targetBuf->elementShift);
+    targetBuf->fPos += dequeueSize;
+    CircularBuffer_PersistFront(targetBuf);
+}
+
 /**
   * @brief  CircularBuffer_Enqueue() : This function is used to "En-queue" an input data into a FIFO circular buffer.
+  *                                   When enqueueSize is larger than free space, the result depends on overflow policy of buffer,
+  *                                   see CircularBuffer_SetOverflowPolicy().
   * @param  targetBuf    : target circular buffer
   * @param  enqueueData  : enqueued data pointer
   * @param  enqueueSize  : size of enqueued data (#of element)
-  * @retval None
+  * @retval number of en-queued elements
   */
-void CircularBuffer_Enqueue(circularBuffer_TypeDef *targetBuf, const void *enqueueData, uint32_t enqueueSize)
+uint32_t CircularBuffer_Enqueue(circularBuffer_TypeDef *targetBuf, const void *enqueueData, uint32_t enqueueSize)
 {
-    static uint8_t bufferState;
+    circularBufferSpan_TypeDef  span[2];
+    uint32_t                    freeSize = (uint32_t)targetBuf->bufferSize - CircularBuffer_GetCount(targetBuf);
+    uint32_t                    droppedSize = 0;
 
-    /** Check buffer state
-      * 0 -> Empty
-      * 1 -> Full
-      * 2 -> with rear > front
-      * 3 -> with rear < front
-      */
-    if(CircularBuffer_IsEmpty(targetBuf))         bufferState = BUF_STATE_EMPTY;         //Empty state
-    else if(CircularBuffer_IsFull(targetBuf))     bufferState = BUF_STATE_FULL;          //Full state
-    else if(targetBuf->r  > targetBuf->f)         bufferState = BUF_STATE_R_MORE_THAN_F; //rear > front
-    else if(targetBuf->r  < targetBuf->f)         bufferState = BUF_STATE_R_LESS_THAN_F; //rear < front
+    if(enqueueSize > freeSize)
+    {
+        /* Input beyond free space is lost : either not written, or it displaces the oldest elements */
+        droppedSize = enqueueSize - freeSize;
 
-    switch (bufferState){
-    case BUF_STATE_EMPTY:     //Empty state
-        /* Change buffer to non-empty state (buffer is reset) */
-        targetBuf->f = 0;
-        targetBuf->r = 0;
-        goto label1;
-
-    case BUF_STATE_FULL:     //Full state
-        /* Do nothing */
-        break;
-
-    case BUF_STATE_R_MORE_THAN_F:     //rear > front
-        label1:
-        if((targetBuf->r + enqueueSize) <= targetBuf->bufferSize)
-        {
-            /**  memcpy() between buffer and enqueue data
-              *  start from rear:r to r + enqueueSize
-              *  when r + enqueueSize does not exceed end-of-buffer   (Not wrapping)
-              *  then, copy only 1 section
-              */
-            memcpy((void *)((uint8_t *)(targetBuf->buf) + targetBuf->elementSize*targetBuf->r), enqueueData, (targetBuf->elementSize)*enqueueSize);
-            targetBuf->r = (targetBuf->r + enqueueSize)%targetBuf->bufferSize;
-        }
-        else
-        {
-             /**  memcpy() between buffer and enqueue data
-              *  start from rear:r to r + enqueueSize
-              *  when r + enqueueSize exceed end-of-buffer            (Wrapping)
-              *  then, copy with 2 sections
-              */
-
-            /* 1st section copy (r to end-of-buffer part) */
-            memcpy((void *)((uint8_t *)(targetBuf->buf) + targetBuf->r), enqueueData, targetBuf->elementSize*(targetBuf->bufferSize - targetBuf->r));
-            /* 2nd section copy (wrapping part) */
-            // No overwritten occur
-            if(enqueueSize + targetBuf->r - targetBuf->bufferSize <= targetBuf->f)
-            {
-                memcpy(targetBuf->buf, (void *)((uint8_t *)(enqueueData) + targetBuf->elementSize*(targetBuf->bufferSize - targetBuf->r)), targetBuf->elementSize*(enqueueSize + targetBuf->r - targetBuf->bufferSize));
-                targetBuf->r = (targetBuf->r + enqueueSize)%targetBuf->bufferSize;
-            }
-            // Overwritten occur during wrapping!
-            else
+        switch (targetBuf->overflowPolicy){
+        case BUF_OVERFLOW_REJECT:
+            /* All or nothing */
+            CIRCULAR_BUFFER_TRACE(drop, targetBuf, enqueueSize, enqueueSize, (uint32_t)targetBuf->bufferSize - freeSize);
+            if(targetBuf->stats != NULL)    CircularBuffer_CountEnqueue(targetBuf, 0, enqueueSize);
+            return 0;
+
+        case BUF_OVERFLOW_OVERWRITE:
+            /* Only the newest bufferSize elements of input can be kept */
+            if(enqueueSize > (uint32_t)targetBuf->bufferSize)
             {
-                memcpy(targetBuf->buf, (void *)((uint8_t *)(enqueueData) + targetBuf->elementSize*(targetBuf->bufferSize - targetBuf->r)), targetBuf->elementSize*(targetBuf->f));
-                targetBuf->r = targetBuf->f;
+                enqueueData = (const void *)((const uint8_t *)(enqueueData) + targetBuf->elementSize*(enqueueSize - targetBuf->bufferSize));
+                enqueueSize = targetBuf->bufferSize;
             }
+            CIRCULAR_BUFFER_TRACE(overwrite, targetBuf, enqueueSize - freeSize, droppedSize - (enqueueSize - freeSize), (uint32_t)targetBuf->bufferSize - freeSize);
+
+            /* Drop the oldest elements to make space, they are overwritten right after */
+            CircularBuffer_AdvanceFront(targetBuf, enqueueSize - freeSize);
+            break;
+
+        default:    //BUF_OVERFLOW_PARTIAL
+            CIRCULAR_BUFFER_TRACE(drop, targetBuf, droppedSize, enqueueSize, (uint32_t)targetBuf->bufferSize - freeSize);
+            enqueueSize = freeSize;
+            break;
         }
-        break;
-
-    case BUF_STATE_R_LESS_THAN_F:     //rear < front
-        if(targetBuf->r + enqueueSize <= targetBuf->f)
-        {
-            /**  memcpy() between buffer and enqueue data
-              *  start from rear:r to r + enqueueSize
-              *  when r + enqueueSize is not exceed front : f   (Overwritten do not occur)
-              */
-            memcpy((void *)((uint8_t *)(targetBuf->buf) + targetBuf->elementSize*targetBuf->r), enqueueData, targetBuf->elementSize*enqueueSize);
-            targetBuf->r = (targetBuf->r + enqueueSize)%targetBuf->bufferSize;
-        }
-        else
-        {
-            /**  memcpy() between buffer and enqueue data
-              *  start from rear:r to r + enqueueSize
-              *  when r + enqueueSize is exceed front : f       (Overwritten occur!)
-              */
-            memcpy((void *)((uint8_t *)(targetBuf->buf) + targetBuf->elementSize*targetBuf->r), enqueueData, targetBuf->elementSize*(targetBuf->f - targetBuf->r));
-            targetBuf->r = targetBuf->f;
-        }
-        break;
+    }
 
-    default:
-        /* Do nothing */
-        break;
+    if(targetBuf->mode == BUF_MODE_POW2)
+    {
+        CircularBuffer_EnqueuePow2(targetBuf, enqueueData, enqueueSize);
+    }
+    else
+    {
+        /* Copy with 1 section, or 2 sections when wrapping */
+        CircularBuffer_GetSpans(targetBuf, CircularBuffer_GetRearIndex(targetBuf), enqueueSize, span);
+        memcpy(span[0].data, enqueueData, targetBuf->elementSize*span[0].size);
+        memcpy(span[1].data, (const void *)((const uint8_t *)(enqueueData) + targetBuf->elementSize*span[0].size), targetBuf->elementSize*span[1].size);
+        CircularBuffer_AdvanceRear(targetBuf, enqueueSize);
     }
+    CircularBuffer_CheckEvent(targetBuf, (uint32_t)targetBuf->bufferSize - freeSize);
+    if(targetBuf->watermark != NULL)    CircularBuffer_CheckWatermark(targetBuf);
+    if(targetBuf->stats != NULL)        CircularBuffer_CountEnqueue(targetBuf, enqueueSize, droppedSize);
+    CIRCULAR_BUFFER_LATENCY_MARK(targetBuf, enqueueSize);
+    CIRCULAR_BUFFER_TRACE(enqueue, targetBuf, enqueueSize, droppedSize, CircularBuffer_GetCount(targetBuf));
+    return enqueueSize;
 }
 
 /**
   * @brief  CircularBuffer_Dequeue() : This function is used to "De-queue" an input data into a FIFO circular buffer.
+  *                                   When dequeueSize is larger than number of elements, only the available elements are de-queued.
   * @param  targetBuf    : target circular buffer
   * @param  dequeueData  : dequeued data pointer
   * @param  dequeueSize  : size of dequeued data (#of element)
-  * @retval None
+  * @retval number of de-queued elements
   */
-void CircularBuffer_Dequeue(circularBuffer_TypeDef *targetBuf, void *dequeueData, uint32_t dequeueSize)
-{
-    static uint8_t bufferState;
-
-    /** Check buffer state
-      * 0 -> Empty
-      * 1 -> with rear > front
-      * 2 -> with rear <= front
-      */
-    if(CircularBuffer_IsEmpty(targetBuf))         bufferState = BUF_STATE_EMPTY;          //Empty state
-    else if(targetBuf->r  >  targetBuf->f)        bufferState = BUF_STATE_R_MORE_THAN_F;  //rear > front
-    else if(targetBuf->r  <= targetBuf->f)        bufferState = BUF_STATE_R_LESS_THAN_F;  //rear <= front
-
-    switch (bufferState){
-    case BUF_STATE_EMPTY:     //Empty state
-        /* Buffer is empty, There's no data in buffer. So, do nothing. */
-        break;
-
-    case BUF_STATE_R_MORE_THAN_F:     //rear > front
-        if(dequeueSize <= (targetBuf->r - targetBuf->f))
-        {
-            /**  memcpy() between buffer and dequeue data
-              *  start from front:f to f + dequeueSize
-              *  when f + dequeueSize does not exceed r
-              */
-            memcpy(dequeueData, (void *)((uint8_t *)(targetBuf->buf) + targetBuf->elementSize*targetBuf->f), (targetBuf->elementSize)*dequeueSize);
-            memset((void *)((uint8_t *)(targetBuf->buf) + (targetBuf->elementSize)*targetBuf->f), 0, (targetBuf->elementSize)*(dequeueSize));
-            targetBuf->f = targetBuf->f + dequeueSize;
-        }
-        else
-        {
-            /**  memcpy() between buffer and dequeue data
-              *  start from front:f to f + dequeueSize
-              *  when f + dequeueSize exceed r  (overwritten occur!)
-              */
-            memcpy(dequeueData, (void *)((uint8_t *)(targetBuf->buf) + targetBuf->elementSize*targetBuf->f), targetBuf->elementSize*(targetBuf->r - targetBuf->f));
-            memset((void *)((uint8_t *)(targetBuf->buf) + (targetBuf->elementSize)*targetBuf->f), 0, (targetBuf->elementSize)*(targetBuf->r - targetBuf->f));
-            targetBuf->r = targetBuf->r;
-        }
+uint32_t CircularBuffer_Dequeue(circularBuffer_TypeDef *targetBuf, void *dequeueData, uint32_t dequeueSize)
+{
+    circularBufferSpan_TypeDef  span[2];
+    uint32_t                    usedSize = CircularBuffer_GetCount(targetBuf);
+    uint32_t                    requestSize = dequeueSize;
 
-        if(targetBuf->f == targetBuf->r)
-        {
-            /** check if buffer is empty after dequeue
-              * then, set r,f to -1
-              */
-            targetBuf->f = -1;
-            targetBuf->r  = -1;
-        }
-        break;
-
-    case BUF_STATE_R_LESS_THAN_F:     //rear <= front
-        if(targetBuf->f + dequeueSize <= targetBuf->bufferSize)
-        {
-            /**  memcpy() between buffer and dequeue data
-              *  start from front:f to f + dequeueSize
-              *  when f + dequeueSize is not exceed end-of-buffer   (Not Wrapping)
-              *  then, dequeue only 1 section
-              */
-            memcpy(dequeueData, (void *)((uint8_t *)(targetBuf->buf) + ((targetBuf->elementSize)*targetBuf->f)), targetBuf->elementSize*(dequeueSize));
-            memset((void *)((uint8_t *)(targetBuf->buf) + (targetBuf->elementSize)*targetBuf->f), 0, (targetBuf->elementSize)*(dequeueSize));
-            targetBuf->f = (targetBuf->f + dequeueSize)%targetBuf->bufferSize;
-        }
-        else
-        {
-            /**  memcpy() between buffer and dequeue data
-              *  start from front:f to f + dequeueSize
-              *  when f + dequeueSize is exceed end-of-buffer   (Wrapping)
-              *  then, dequeue with 2 sections
-              */
-            /* 1st section copy */
-            memcpy(dequeueData, (void *)((uint8_t *)(targetBuf->buf) + ((targetBuf->elementSize)*targetBuf->f)), targetBuf->elementSize*(targetBuf->bufferSize - targetBuf->f));
-            memset((void *)((uint8_t *)(targetBuf->buf) + (targetBuf->elementSize)*targetBuf->f), 0, (targetBuf->elementSize)*(targetBuf->bufferSize - targetBuf->f));
-
-            /* 2nd section copy (wrapping part) */
-            // No overwritten occur
-            if(dequeueSize + targetBuf->f - targetBuf->bufferSize <= targetBuf->r)
-            {
-                memcpy((void *)((uint8_t *)(dequeueData) + targetBuf->elementSize*(targetBuf->bufferSize - targetBuf->f)), targetBuf->buf, targetBuf->elementSize*(dequeueSize + targetBuf->f - targetBuf->bufferSize));
-                memset(targetBuf->buf, 0, targetBuf->elementSize*(dequeueSize + targetBuf->f - targetBuf->bufferSize));
-                targetBuf->f = (targetBuf->f + dequeueSize)%targetBuf->bufferSize;
-            }
-            // Overwritten occur during wrapping!
-            else
-            {
-                memcpy((void *)((uint8_t *)(dequeueData) + targetBuf->elementSize*(targetBuf->bufferSize - targetBuf->f)), targetBuf->buf, targetBuf->elementSize*(targetBuf->r));
-                memset(targetBuf->buf, 0, targetBuf->elementSize*(targetBuf->r));
-                targetBuf->f = targetBuf->r;
-            }
-        }
-        if(targetBuf->f == targetBuf->r)
-        {
-            /** check if buffer is empty after dequeue
-              * then, set r,f to -1
-              */
-            targetBuf->f = -1;
-            targetBuf->r = -1;
-        }
-        break;
+    if(dequeueSize > usedSize)      dequeueSize = usedSize;
+
+    if(targetBuf->mode == BUF_MODE_POW2)
+    {
+        CircularBuffer_DequeuePow2(targetBuf, dequeueData, dequeueSize);
+    }
+    else
+    {
+        /* Copy with 1 section, or 2 sections when wrapping */
+        CircularBuffer_GetSpans(targetBuf, CircularBuffer_GetFrontIndex(targetBuf), dequeueSize, span);
+        memcpy(dequeueData, span[0].data, targetBuf->elementSize*span[0].size);
+        CircularBuffer_Scrub(targetBuf, span[0].data, targetBuf->elementSize*span[0].size);
+        memcpy((void *)((uint8_t *)(dequeueData) + targetBuf->elementSize*span[0].size), span[1].data, targetBuf->elementSize*span[1].size);
+        CircularBuffer_Scrub(targetBuf, span[1].data, targetBuf->elementSize*span[1].size);
+        CircularBuffer_AdvanceFront(targetBuf, dequeueSize);
+    }
+    if(targetBuf->watermark != NULL)    CircularBuffer_CheckWatermark(targetBuf);
+    if(targetBuf->stats != NULL)        CircularBuffer_CountDequeue(targetBuf, dequeueSize, requestSize);
+    CIRCULAR_BUFFER_TRACE(dequeue, targetBuf, dequeueSize, requestSize, CircularBuffer_GetCount(targetBuf));
+    return dequeueSize;
+}
+
+/**
+  * @brief  CircularBuffer_Reserve() : This function is used to get a writable region at rear of a circular buffer, without copying.
+  *                                   Producer writes data in place, then calls CircularBuffer_Commit() to en-queue it.
+  *                                   The region is described by 2 spans, span[1].size is 0 if the region is not wrapping.
+  * @param  targetBuf    : target circular buffer
+  * @param  span         : output array of 2 spans
+  * @param  reserveSize  : requested size of region (#of element)
+  * @retval size of writable region (limited by free space of buffer)
+  */
+uint32_t CircularBuffer_Reserve(circularBuffer_TypeDef *targetBuf, circularBufferSpan_TypeDef span[2], uint32_t reserveSize)
+{
+    uint32_t freeSize = (uint32_t)targetBuf->bufferSize - CircularBuffer_GetCount(targetBuf);
+
+    if(reserveSize > freeSize)      reserveSize = freeSize;
+    CircularBuffer_GetSpans(targetBuf, CircularBuffer_GetRearIndex(targetBuf), reserveSize, span);
+    return reserveSize;
+}
 
-    default:
-        break;
+/**
+  * @brief  CircularBuffer_Commit() : This function is used to "En-queue" elements written in place after CircularBuffer_Reserve().
+  * @param  targetBuf    : target circular buffer
+  * @param  commitSize   : number of written elements (#of element), from start of span[0] and continued in span[1]
+  * @retval number of en-queued elements (limited by free space of buffer)
+  */
+uint32_t CircularBuffer_Commit(circularBuffer_TypeDef *targetBuf, uint32_t commitSize)
+{
+    uint32_t freeSize = (uint32_t)targetBuf->bufferSize - CircularBuffer_GetCount(targetBuf);
+    uint32_t droppedSize = 0;
+
+    if(commitSize > freeSize)
+    {
+        droppedSize = commitSize - freeSize;
+        CIRCULAR_BUFFER_TRACE(drop, targetBuf, droppedSize, commitSize, (uint32_t)targetBuf->bufferSize - freeSize);
+        commitSize = freeSize;
     }
+    CircularBuffer_AdvanceRear(targetBuf, commitSize);
+    CircularBuffer_CheckEvent(targetBuf, (uint32_t)targetBuf->bufferSize - freeSize);
+    if(targetBuf->watermark != NULL)    CircularBuffer_CheckWatermark(targetBuf);
+    if(targetBuf->stats != NULL)        CircularBuffer_CountEnqueue(targetBuf, commitSize, droppedSize);
+    CIRCULAR_BUFFER_LATENCY_MARK(targetBuf, commitSize);
+    CIRCULAR_BUFFER_TRACE(enqueue, targetBuf, commitSize, droppedSize, CircularBuffer_GetCount(targetBuf));
+    return commitSize;
+}
+
+/**
+  * @brief  CircularBuffer_Peek() : This function is used to get the readable region at front of a circular buffer, without copying.
+  *                                The region is described by 2 spans, span[1].size is 0 if the region is not wrapping.
+  *                                Data in spans must not be modified, and is valid until CircularBuffer_Consume() or the next en-queue.
+  * @param  targetBuf    : target circular buffer
+  * @param  span         : output array of 2 spans
+  * @param  peekSize     : requested size of region (#of element)
+  * @retval size of readable region (limited by number of elements in buffer)
+  */
+uint32_t CircularBuffer_Peek(circularBuffer_TypeDef *targetBuf, circularBufferSpan_TypeDef span[2], uint32_t peekSize)
+{
+    uint32_t usedSize = CircularBuffer_GetCount(targetBuf);
+
+    if(peekSize > usedSize)     peekSize = usedSize;
+    CircularBuffer_GetSpans(targetBuf, CircularBuffer_GetFrontIndex(targetBuf), peekSize, span);
+    return peekSize;
 }
 
+/**
+  * @brief  CircularBuffer_Consume() : This function is used to "De-queue" elements at front of a circular buffer, without copying.
+  *                                   Usually called after reading the elements in place with CircularBuffer_Peek().
+  *
+  *                                   Warning! : Unlike CircularBuffer_Dequeue(), the consumed region is not cleared,
+  *                                              except with BUF_SCRUB_SECURE policy.
+  * @param  targetBuf    : target circular buffer
+  * @param  consumeSize  : number of elements to de-queue (#of element)
+  * @retval number of de-queued elements (limited by number of elements in buffer)
+  */
+uint32_t CircularBuffer_Consume(circularBuffer_TypeDef *targetBuf, uint32_t consumeSize)
+{
+    circularBufferSpan_TypeDef  span[2];
+    uint32_t                    usedSize = CircularBuffer_GetCount(targetBuf);
+    uint32_t                    requestSize = consumeSize;
+
+    if(consumeSize > usedSize)      consumeSize = usedSize;
+    if(targetBuf->scrubPolicy == BUF_SCRUB_SECURE)
+    {
+        CircularBuffer_GetSpans(targetBuf, CircularBuffer_GetFrontIndex(targetBuf), consumeSize, span);
+        CircularBuffer_SecureMemset(span[0].data, 0, targetBuf->elementSize*span[0].size);
+        CircularBuffer_SecureMemset(span[1].data, 0, targetBuf->elementSize*span[1].size);
+    }
+    CircularBuffer_AdvanceFront(targetBuf, consumeSize);
+    if(targetBuf->watermark != NULL)    CircularBuffer_CheckWatermark(targetBuf);
+    if(targetBuf->stats != NULL)        CircularBuffer_CountDequeue(targetBuf, consumeSize, requestSize);
+    CIRCULAR_BUFFER_TRACE(dequeue, targetBuf, consumeSize, requestSize, CircularBuffer_GetCount(targetBuf));
+    return consumeSize;
+}
 
+/**
+  * @brief  CircularBuffer_PeekAt() : This function is used to read an element of a circular buffer by its position from front, without de-queueing.
+  *                                  Index 0 is the oldest element. Front and rear are not modified.
+  * @param  targetBuf    : target circular buffer
+  * @param  index        : position from front (0 to number of elements - 1)
+  * @retval pointer of the element in buffer, NULL -> index is out of range
+  */
+void *CircularBuffer_PeekAt(circularBuffer_TypeDef *targetBuf, uint32_t index)
+{
+    if(index >= CircularBuffer_GetCount(targetBuf))     return NULL;
 
+    index += CircularBuffer_GetFrontIndex(targetBuf);
+    if(index >= (uint32_t)targetBuf->bufferSize)        index -= (uint32_t)targetBuf->bufferSize;
+    return (void *)((uint8_t *)(targetBuf->buf) + targetBuf->elementSize*index);
+}
+
+/**
+  * @brief  CircularBuffer_PeekAtRear() : This function is used to read an element of a circular buffer by its position from rear, without de-queueing.
+  *                                      Index 0 is the newest element. Front and rear are not modified.
+  * @param  targetBuf    : target circular buffer
+  * @param  index        : position from rear (0 to number of elements - 1)
+  * @retval pointer of the element in buffer, NULL -> index is out of range
+  */
+void *CircularBuffer_PeekAtRear(circularBuffer_TypeDef *targetBuf, uint32_t index)
+{
+    uint32_t usedSize = CircularBuffer_GetCount(targetBuf);
+
+    if(index >= usedSize)       return NULL;
+    return CircularBuffer_PeekAt(targetBuf, usedSize - 1 - index);
+}
+
+/**
+  * @brief  CircularBuffer_CopyLast() : This function is used to copy the newest elements of a circular buffer, without de-queueing.
+  *                                    Elements are copied from oldest to newest, a wrapped region is copied with 2 sections.
+  *                                    Front and rear are not modified, so a monitoring reader does not disturb the consumer.
+  * @param  targetBuf    : target circular buffer
+  * @param  copyData     : output data pointer
+  * @param  copySize     : number of newest elements to copy (#of element)
+  * @retval number of copied elements (limited by number of elements in buffer)
+  */
+uint32_t CircularBuffer_CopyLast(circularBuffer_TypeDef *targetBuf, void *copyData, uint32_t copySize)
+{
+    circularBufferSpan_TypeDef  span[2];
+    uint32_t                    usedSize = CircularBuffer_GetCount(targetBuf);
+    uint32_t                    index;
+
+    if(copySize > usedSize)     copySize = usedSize;
+
+    index = CircularBuffer_GetFrontIndex(targetBuf) + (usedSize - copySize);
+    if(index >= (uint32_t)targetBuf->bufferSize)        index -= (uint32_t)targetBuf->bufferSize;
+
+    CircularBuffer_GetSpans(targetBuf, index, copySize, span);
+    memcpy(copyData, span[0].data, targetBuf->elementSize*span[0].size);
+    memcpy((void *)((uint8_t *)(copyData) + targetBuf->elementSize*span[0].size), span[1].data, targetBuf->elementSize*span[1].size);
+    return copySize;
+}
+
+/**
+  * @brief  CircularBuffer_Resize() : This function is used to grow or shrink a circular buffer into a new storage array.
+  *                                   Elements in buffer are moved in order, policies and callbacks are kept.
+  *                                   The old storage array can be released after return.
+  *
+  *                                   Warning! : Not for a mirrored buffer, a buffer of CircularBuffer_Create() or of
+  *                                              CircularBuffer_OpenPersistent(). For the lock-free buffer with a running
+  *                                              producer, use CircularBufferSPSC_Resize() instead.
+  * @param  targetBuf     : target circular buffer
+  * @param  pNewBuf       : pointer of new storage buffer array
+  * @param  SetBufferSize : new size of buffer (elements), must be a power of two for BUF_MODE_POW2
+  * @retval 0 -> success
+  *         1 -> error, buffer holds more elements than SetBufferSize, or buffer/size is not supported (nothing is changed)
+  */
+uint8_t CircularBuffer_Resize(circularBuffer_TypeDef *targetBuf, void *pNewBuf, int32_t SetBufferSize)
+{
+    circularBufferSpan_TypeDef  span[2];
+    uint32_t                    usedSize = CircularBuffer_GetCount(targetBuf);
+    uint32_t                    index;
+    uint32_t                    newMask;
+    uint32_t                    firstSize;
+    uint32_t                    i;
+
+    if((SetBufferSize <= 0) || (usedSize > (uint32_t)SetBufferSize))     return 1;
+    if(targetBuf->mirrored || targetBuf->allocPage || targetBuf->persistent)        return 1;
+    if((targetBuf->mode == BUF_MODE_POW2) && ((SetBufferSize & (SetBufferSize - 1)) != 0))    return 1;
+
+    /* BUF_MODE_POW2 keeps rPos,fPos, so the 1st element moves to (fPos & new mask). BUF_MODE_DEFAULT restarts at index 0 */
+    newMask = (uint32_t)SetBufferSize - 1;
+    index = (targetBuf->mode == BUF_MODE_POW2) ? ((uint32_t)targetBuf->fPos & newMask) : 0;
+
+    memset(pNewBuf, 0, targetBuf->elementSize*SetBufferSize);
+    CircularBuffer_GetSpans(targetBuf, CircularBuffer_GetFrontIndex(targetBuf), usedSize, span);
+    for(i=0; i<2; i++)
+    {
+        firstSize = (uint32_t)SetBufferSize - index;
+        if(firstSize > span[i].size)    firstSize = span[i].size;
+        memcpy((void *)((uint8_t *)(pNewBuf) + targetBuf->elementSize*index), span[i].data, targetBuf->elementSize*firstSize);
+        memcpy(pNewBuf, (const void *)((const uint8_t *)(span[i].data) + targetBuf->elementSize*firstSize), targetBuf->elementSize*(span[i].size - firstSize));
+        index = (index + span[i].size) % (uint32_t)SetBufferSize;
+    }
+
+    targetBuf->buf = pNewBuf;
+    targetBuf->bufferSize = SetBufferSize;
+    if(targetBuf->mode == BUF_MODE_POW2)
+    {
+        targetBuf->mask = newMask;
+    }
+    else
+    {
+        targetBuf->f = -1;
+        targetBuf->r = -1;
+        CircularBuffer_AdvanceRear(targetBuf, usedSize);
+    }
+    return 0;
+}
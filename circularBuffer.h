@@ -17,19 +17,93 @@
 #include <stdlib.h>
 #include <stdint.h>
 #include <string.h>
+#include <stdatomic.h>
 
 /* Define for default setup of buffer data structure */
 #define     DEFAULT_CIRCULAR_BUFFER_SIZE    2048
 #define     _DEFAULT_BUFFER_DATA_TYPE       int32_t
 
+/* Size of a cache line (bytes), used to place producer and consumer indices of the lock-free buffers on separate lines */
+#define     CIRCULAR_BUFFER_CACHE_LINE_SIZE 64
+
 /* Define of all buffer states */
 #define     BUF_STATE_EMPTY                 0
 #define     BUF_STATE_FULL                  1
 #define     BUF_STATE_R_MORE_THAN_F         2
 #define     BUF_STATE_R_LESS_THAN_F         3
 
+/* Define of buffer index modes */
+#define     BUF_MODE_DEFAULT                0       //r,f are wrapped indices with -1 as empty state
+#define     BUF_MODE_POW2                   1       //rPos,fPos are 64-bit positions, wrapped with mask (power-of-two capacity)
+
+/* Define of scrub policies (how de-queued data is cleared) */
+#define     BUF_SCRUB_NONE                  0
+#define     BUF_SCRUB_ZERO                  1       //default
+#define     BUF_SCRUB_SECURE                2
+
+/* Define of overflow policies (what en-queue does when data does not fit) */
+#define     BUF_OVERFLOW_REJECT             0
+#define     BUF_OVERFLOW_PARTIAL            1       //default
+#define     BUF_OVERFLOW_OVERWRITE          2
+#define     BUF_OVERFLOW_BLOCK              3
+
 typedef _DEFAULT_BUFFER_DATA_TYPE   _RING_BUFFER_DATA_TYPE;
 
+/* Contiguous region inside a buffer, used by the zero-copy functions (a wrapped region is described by 2 spans) */
+typedef struct {
+
+    void                *data;          //pointer of 1st element in region
+    uint32_t            size;           //region size (elements)
+
+} circularBufferSpan_TypeDef;
+
+/* Readiness notification of a buffer (see circularBuffer_event.h) */
+typedef struct circularBufferEvent {
+
+    int32_t             fd;             //file descriptor, readable when level is reached
+    uint32_t            level;          //number of elements which makes fd readable
+    uint8_t             fromFrame;      //1 -> level follows the frame extraction of buffer
+    void                (*signal)(struct circularBufferEvent *event);
+
+} circularBufferEvent_TypeDef;
+
+/* High/low watermark callbacks of a buffer (see CircularBuffer_SetWatermark()) */
+typedef struct {
+
+    uint32_t            highLevel;      //onHigh() is called when number of elements rises to highLevel
+    uint32_t            lowLevel;       //onLow() is called when number of elements falls to lowLevel, after onHigh()
+    void                (*onHigh)(void *userData, uint32_t count);     //NULL -> not called
+    void                (*onLow)(void *userData, uint32_t count);      //NULL -> not called
+    void                *userData;      //passed to callbacks
+    uint8_t             isHigh;         //hysteresis state, 1 -> onHigh() was called last (set by buffer)
+
+} circularBufferWatermark_TypeDef;
+
+/* Statistics counters of a buffer (see CircularBuffer_SetStats()).
+   Only the thread using the buffer writes them, other threads can scrape them with CircularBuffer_GetStats() */
+typedef struct {
+
+    _Atomic uint64_t    enqueued;       //elements en-queued (Enqueue, Commit)
+    _Atomic uint64_t    dequeued;       //elements de-queued (Dequeue, Consume)
+    _Atomic uint64_t    overrun;        //elements dropped by en-queue : not written (REJECT, PARTIAL) or overwritten (OVERWRITE)
+    _Atomic uint64_t    underrun;       //de-queue requests which got fewer elements than requested
+    _Atomic uint64_t    wraps;          //number of times rear wrapped to start of buf
+    _Atomic uint32_t    maxFill;        //highest number of elements after en-queue
+
+} circularBufferStats_TypeDef;
+
+/* Copy of statistics counters, output of CircularBuffer_GetStats() */
+typedef struct {
+
+    uint64_t            enqueued;
+    uint64_t            dequeued;
+    uint64_t            overrun;
+    uint64_t            underrun;
+    uint64_t            wraps;
+    uint32_t            maxFill;
+
+} circularBufferStatsSnapshot_TypeDef;
+
 typedef struct {
 
     void                *buf;           //pointer of 1-D data array
@@ -38,24 +112,91 @@ typedef struct {
     int32_t		        	bufferSize;     //buffer size (elements)
     int8_t              elementSize;    //size per element (bytes)
 
+    uint8_t             mode;           //index mode (BUF_MODE_DEFAULT or BUF_MODE_POW2)
+    uint8_t             elementShift;   //log2(elementSize)         (BUF_MODE_POW2 only)
+    uint32_t            mask;           //bufferSize - 1            (BUF_MODE_POW2 only)
+    uint64_t            rPos;           //total enqueued elements   (BUF_MODE_POW2 only)
+    uint64_t            fPos;           //total dequeued elements   (BUF_MODE_POW2 only)
+    uint8_t             mirrored;       //1 -> buf is mapped twice back to back (see circularBuffer_mirror.h)
+    uint8_t             allocPage;      //0 -> buf is from caller, else page size of CircularBuffer_Create() (see circularBuffer_alloc.h)
+    uint8_t             persistent;     //1 -> buf is a file mapping of CircularBuffer_OpenPersistent() (see circularBuffer_persist.h)
+    struct circularBufferPersistHeader *persistHeader;  //file header, rPos,fPos are stored into it on each change (NULL -> none)
+    uint8_t             scrubPolicy;    //BUF_SCRUB_NONE, BUF_SCRUB_ZERO or BUF_SCRUB_SECURE
+    uint8_t             overflowPolicy; //BUF_OVERFLOW_REJECT, BUF_OVERFLOW_PARTIAL, BUF_OVERFLOW_OVERWRITE or BUF_OVERFLOW_BLOCK
+    circularBufferEvent_TypeDef *event; //readiness notification (NULL -> none)
+    circularBufferWatermark_TypeDef *watermark;     //high/low watermark callbacks (NULL -> none)
+    circularBufferStats_TypeDef *stats; //statistics counters (NULL -> none)
+#if defined(CIRCULAR_BUFFER_LATENCY)
+    struct circularBufferLatency *latency;          //enqueue-to-frame latency tracker (NULL -> none, see circularBuffer_latency.h)
+#endif
+
 } circularBuffer_TypeDef;
 
 /* Function Prototyping for circularBuffer.h */
-void CircularBuffer_Enqueue (circularBuffer_TypeDef *targetBuf,
-                             const void *enqueueData,
-                             uint32_t enqueueSize);
+uint32_t CircularBuffer_Enqueue (circularBuffer_TypeDef *targetBuf,
+                                 const void *enqueueData,
+                                 uint32_t enqueueSize);
 
-void CircularBuffer_Dequeue (circularBuffer_TypeDef *targetBuf,
-                             void *dequeueData,
-                             uint32_t dequeueSize);
+uint32_t CircularBuffer_Dequeue (circularBuffer_TypeDef *targetBuf,
+                                 void *dequeueData,
+                                 uint32_t dequeueSize);
 
 void CircularBuffer_Init    (circularBuffer_TypeDef *targetBuf,
                              void *pBuf,
                              int8_t SetElementSize,
                              int32_t SetBufferSize);
 
-void    CircularBuffer_Flush    (circularBuffer_TypeDef *targetBuf);
-uint8_t CircularBuffer_IsEmpty  (circularBuffer_TypeDef *targetBuf);
-uint8_t CircularBuffer_IsFull   (circularBuffer_TypeDef *targetBuf);
+uint8_t CircularBuffer_InitPow2(circularBuffer_TypeDef *targetBuf,
+                                void *pBuf,
+                                int8_t SetElementSize,
+                                int32_t SetBufferSize);
+
+void     CircularBuffer_SetScrubPolicy(circularBuffer_TypeDef *targetBuf,
+                                      uint8_t policy);
+
+void     CircularBuffer_SetOverflowPolicy(circularBuffer_TypeDef *targetBuf,
+                                         uint8_t policy);
+
+uint8_t  CircularBuffer_SetWatermark(circularBuffer_TypeDef *targetBuf,
+                                     circularBufferWatermark_TypeDef *watermark);
+
+void     CircularBuffer_SetStats(circularBuffer_TypeDef *targetBuf,
+                                circularBufferStats_TypeDef *stats);
+
+uint8_t  CircularBuffer_GetStats(circularBuffer_TypeDef *targetBuf,
+                                circularBufferStatsSnapshot_TypeDef *snapshot);
+
+uint32_t CircularBuffer_Reserve (circularBuffer_TypeDef *targetBuf,
+                                 circularBufferSpan_TypeDef span[2],
+                                 uint32_t reserveSize);
+
+uint32_t CircularBuffer_Commit  (circularBuffer_TypeDef *targetBuf,
+                                 uint32_t commitSize);
+
+uint32_t CircularBuffer_Peek    (circularBuffer_TypeDef *targetBuf,
+                                 circularBufferSpan_TypeDef span[2],
+                                 uint32_t peekSize);
+
+uint32_t CircularBuffer_Consume (circularBuffer_TypeDef *targetBuf,
+                                 uint32_t consumeSize);
+
+void    *CircularBuffer_PeekAt   (circularBuffer_TypeDef *targetBuf,
+                                 uint32_t index);
+
+void    *CircularBuffer_PeekAtRear(circularBuffer_TypeDef *targetBuf,
+                                  uint32_t index);
+
+uint32_t CircularBuffer_CopyLast(circularBuffer_TypeDef *targetBuf,
+                                 void *copyData,
+                                 uint32_t copySize);
+
+uint8_t  CircularBuffer_Resize   (circularBuffer_TypeDef *targetBuf,
+                                 void *pNewBuf,
+                                 int32_t SetBufferSize);
+
+void     CircularBuffer_Flush    (circularBuffer_TypeDef *targetBuf);
+uint32_t CircularBuffer_GetCount (circularBuffer_TypeDef *targetBuf);
+uint8_t  CircularBuffer_IsEmpty  (circularBuffer_TypeDef *targetBuf);
+uint8_t  CircularBuffer_IsFull   (circularBuffer_TypeDef *targetBuf);
 
 #endif
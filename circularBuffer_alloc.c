@@ -0,0 +1,171 @@
+/**
+  * circularBuffer_alloc.c - managed storage allocation (hugepages, NUMA node, locked pages) for circular buffer in C (Linux).
+  *
+  * To the extent possible under law, the author(s) have dedicated all
+  * copyright and related and neighboring rights to this software to
+  * the public domain worldwide. This software is distributed without
+  * any warranty.
+  *
+  * How to use this file:
+    --------------------
+    + CircularBuffer_Create() allocates the storage array of a circular buffer by itself (no pBuf), then initializes the buffer
+      like CircularBuffer_InitPow2() when both sizes are powers of two, otherwise like CircularBuffer_Init().
+    + pageSize selects normal pages or hugepages. For a large history buffer, 2MB/1GB pages reduce the number of TLB misses.
+      Hugepages must be reserved by the system first, CircularBuffer_Create() fails (no silent fallback) when the pool is empty.
+    + numaNode binds the pages to one NUMA node, use the node of the CPUs which run the producer and consumer.
+      Hugepages are reserved by mmap() itself, before the mapping can be bound with mbind(). So the calling thread is also
+      bound to numaNode (set_mempolicy) while the storage is mapped and prefaulted, then its own policy is restored.
+      The reservation is taken from the pool of numaNode, and CircularBuffer_Create() fails when that pool is empty,
+      it never falls back to the pages of another node.
+    + Pages are bound before they are touched, then prefaulted by the zeroing of the buffer, so each page is on the selected node
+      and no page fault is left for the first en-queue. With BUF_ALLOC_MLOCK, the pages are also locked, so they are never
+      swapped out or reclaimed and a real-time thread never takes a page fault on buffer.
+    + Release the storage with CircularBuffer_Destroy().
+**/
+
+#if defined(__linux__)
+#define _GNU_SOURCE
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "circularBuffer_alloc.h"
+
+#if defined(__linux__)
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT      26
+#endif
+#ifndef MAP_HUGE_2MB
+#define MAP_HUGE_2MB        (21 << MAP_HUGE_SHIFT)
+#endif
+#ifndef MAP_HUGE_1GB
+#define MAP_HUGE_1GB        (30 << MAP_HUGE_SHIFT)
+#endif
+#define CIRCULAR_BUFFER_MPOL_BIND       2       //MPOL_BIND of <numaif.h>, used without libnuma
+#define CIRCULAR_BUFFER_MAX_NUMA_NODES  1024
+#define CIRCULAR_BUFFER_NODE_MASK_LONGS (CIRCULAR_BUFFER_MAX_NUMA_NODES/(8*sizeof(unsigned long)) + 1)     //+1, get_mempolicy() may write maxnode bits
+#endif
+
+
+/**
+  * @brief  CircularBuffer_AllocBytes() : Size of the mapping of a buffer (rounded up to page size), 0 -> invalid page size.
+  */
+static size_t CircularBuffer_AllocBytes(int8_t elementSize, int32_t bufferSize, uint8_t pageSize)
+{
+    size_t byteSize = (size_t)elementSize*(size_t)bufferSize;
+    size_t pageBytes;
+
+    switch(pageSize)
+    {
+#if defined(__linux__)
+        case BUF_ALLOC_PAGE_4K  : pageBytes = (size_t)sysconf(_SC_PAGESIZE);    break;
+#endif
+        case BUF_ALLOC_PAGE_2MB : pageBytes = (size_t)2 << 20;                  break;
+        case BUF_ALLOC_PAGE_1GB : pageBytes = (size_t)1 << 30;                  break;
+        default                 : return 0;
+    }
+    return (byteSize + pageBytes - 1)/pageBytes*pageBytes;
+}
+
+/**
+  * @brief  CircularBuffer_Create() : This function is used to "initialize" a FIFO circular buffer struct with managed storage.
+  * @param  targetBuf      : target circular buffer
+  * @param  SetElementSize : size of each element (bytes)
+  * @param  SetBufferSize  : size of buffer (elements)
+  * @param  pageSize       : BUF_ALLOC_PAGE_4K, BUF_ALLOC_PAGE_2MB or BUF_ALLOC_PAGE_1GB
+  * @param  numaNode       : NUMA node of storage, or BUF_ALLOC_NODE_ANY
+  * @param  flags          : 0 or BUF_ALLOC_MLOCK
+  * @retval 0 -> success
+  *         1 -> error, invalid size, no hugepages, binding or locking failed
+  */
+uint8_t CircularBuffer_Create(circularBuffer_TypeDef *targetBuf, int8_t SetElementSize, int32_t SetBufferSize,
+                              uint8_t pageSize, int32_t numaNode, uint8_t flags)
+{
+#if defined(__linux__)
+    unsigned long   nodeMask[CIRCULAR_BUFFER_NODE_MASK_LONGS];
+    unsigned long   oldNodeMask[CIRCULAR_BUFFER_NODE_MASK_LONGS];
+    int             oldPolicy = 0;
+    size_t          mapBytes;
+    int             mapFlags = MAP_PRIVATE | MAP_ANONYMOUS;      //reserved, so an empty hugepage pool fails here instead of SIGBUS on touch
+    void            *base;
+
+    if((SetElementSize <= 0) || (SetBufferSize <= 0))      return 1;
+    if((numaNode != BUF_ALLOC_NODE_ANY) && ((numaNode < 0) || (numaNode >= CIRCULAR_BUFFER_MAX_NUMA_NODES)))     return 1;
+
+    mapBytes = CircularBuffer_AllocBytes(SetElementSize, SetBufferSize, pageSize);
+    if(mapBytes == 0)       return 1;
+
+    if(pageSize == BUF_ALLOC_PAGE_2MB)          mapFlags |= MAP_HUGETLB | MAP_HUGE_2MB;
+    else if(pageSize == BUF_ALLOC_PAGE_1GB)     mapFlags |= MAP_HUGETLB | MAP_HUGE_1GB;
+
+    if(numaNode != BUF_ALLOC_NODE_ANY)
+    {
+        memset(nodeMask, 0, sizeof(nodeMask));
+        nodeMask[numaNode/(8*sizeof(unsigned long))] = 1UL << (numaNode%(8*sizeof(unsigned long)));
+
+        /* Bind the calling thread before mmap(), hugepages are reserved from the pools of its allowed nodes */
+        if(syscall(SYS_get_mempolicy, &oldPolicy, oldNodeMask, (unsigned long)CIRCULAR_BUFFER_MAX_NUMA_NODES + 1, NULL, 0) != 0)     return 1;
+        if(syscall(SYS_set_mempolicy, CIRCULAR_BUFFER_MPOL_BIND, nodeMask, (unsigned long)CIRCULAR_BUFFER_MAX_NUMA_NODES + 1) != 0)   return 1;
+    }
+
+    base = mmap(NULL, mapBytes, PROT_READ | PROT_WRITE, mapFlags, -1, 0);
+
+    /* Bind the mapping too, so its pages stay on numaNode after the thread policy is restored */
+    if((base != MAP_FAILED) && (numaNode != BUF_ALLOC_NODE_ANY) &&
+       (syscall(SYS_mbind, base, mapBytes, CIRCULAR_BUFFER_MPOL_BIND, nodeMask, (unsigned long)CIRCULAR_BUFFER_MAX_NUMA_NODES + 1, 0) != 0))
+    {
+        munmap(base, mapBytes);
+        base = MAP_FAILED;
+    }
+
+    /* Init zeroes the whole storage, which prefaults every page */
+    if((base != MAP_FAILED) && (CircularBuffer_InitPow2(targetBuf, base, SetElementSize, SetBufferSize) != 0))
+    {
+        CircularBuffer_Init(targetBuf, base, SetElementSize, SetBufferSize);
+    }
+
+    if(numaNode != BUF_ALLOC_NODE_ANY)
+    {
+        syscall(SYS_set_mempolicy, oldPolicy, oldNodeMask, (unsigned long)CIRCULAR_BUFFER_MAX_NUMA_NODES + 1);
+    }
+    if(base == MAP_FAILED)      return 1;
+
+    if((flags & BUF_ALLOC_MLOCK) && (mlock(base, mapBytes) != 0))
+    {
+        munmap(base, mapBytes);
+        targetBuf->buf = NULL;
+        return 1;
+    }
+    targetBuf->allocPage = pageSize;
+    return 0;
+#else
+    (void)targetBuf;
+    (void)SetElementSize;
+    (void)SetBufferSize;
+    (void)pageSize;
+    (void)numaNode;
+    (void)flags;
+    return 1;
+#endif
+}
+
+/**
+  * @brief  CircularBuffer_Destroy() : This function is used to release the storage of a buffer from CircularBuffer_Create().
+  * @param  targetBuf : target circular buffer
+  * @retval None
+  */
+void CircularBuffer_Destroy(circularBuffer_TypeDef *targetBuf)
+{
+#if defined(__linux__)
+    if(targetBuf->allocPage != 0)
+    {
+        /* munmap() also unlocks the pages */
+        munmap(targetBuf->buf, CircularBuffer_AllocBytes(targetBuf->elementSize, targetBuf->bufferSize, targetBuf->allocPage));
+        targetBuf->buf = NULL;
+        targetBuf->allocPage = 0;
+    }
+#else
+    (void)targetBuf;
+#endif
+}
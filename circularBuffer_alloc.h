@@ -0,0 +1,42 @@
+/**
+  * circularBuffer_alloc.h - managed storage allocation (hugepages, NUMA node, locked pages) for circular buffer in C (Linux).
+  *
+  * To the extent possible under law, the author(s) have dedicated all
+  * copyright and related and neighboring rights to this software to
+  * the public domain worldwide. This software is distributed without
+  * any warranty.
+  *
+  */
+
+#ifndef  __CIRCULARBUFFER_ALLOC_H
+#define  __CIRCULARBUFFER_ALLOC_H
+
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "circularBuffer.h"
+
+/* Define of page sizes for storage of CircularBuffer_Create() */
+#define     BUF_ALLOC_PAGE_4K               1       //normal pages
+#define     BUF_ALLOC_PAGE_2MB              2       //hugepages, needs /proc/sys/vm/nr_hugepages (2MB pool)
+#define     BUF_ALLOC_PAGE_1GB              3       //hugepages, needs a reserved 1GB pool
+
+/* Define of NUMA node for CircularBuffer_Create() */
+#define     BUF_ALLOC_NODE_ANY              (-1)    //default policy of calling thread (first touch)
+
+/* Define of option flags for CircularBuffer_Create() */
+#define     BUF_ALLOC_MLOCK                 0x01    //lock pages in RAM, needs RLIMIT_MEMLOCK or CAP_IPC_LOCK
+
+/* Function Prototyping for circularBuffer_alloc.h */
+uint8_t CircularBuffer_Create   (circularBuffer_TypeDef *targetBuf,
+                                 int8_t SetElementSize,
+                                 int32_t SetBufferSize,
+                                 uint8_t pageSize,
+                                 int32_t numaNode,
+                                 uint8_t flags);
+
+void    CircularBuffer_Destroy  (circularBuffer_TypeDef *targetBuf);
+
+#endif
@@ -0,0 +1,239 @@
+/**
+  * circularBuffer_broadcast.c - lock-free broadcast circular buffer (1 producer, N consumers) in C.
+  *
+  * To the extent possible under law, the author(s) have dedicated all
+  * copyright and related and neighboring rights to this software to
+  * the public domain worldwide. This software is distributed without
+  * any warranty.
+  *
+  * How to use this file:
+    --------------------
+    + First, you need to declare a buffer structure with "circularBufferBroadcast_TypeDef" type in circularBuffer_broadcast.h.
+    + Every registered consumer reads the same stream with its own front cursor, so N consumers share one copy of the data.
+      The producer is only held back by the slowest registered cursor.
+    + There're 5 main functions for broadcast circular buffer,
+      1) To initialize a broadcast buffer,                 call the function CircularBufferBroadcast_Init()
+      2) To register a consumer (returns consumer id),     call the function CircularBufferBroadcast_AddConsumer()  (producer thread)
+      3) To En-queue a broadcast buffer,                   call the function CircularBufferBroadcast_Enqueue()      (producer thread)
+      4) To read data in place (zero-copy),                call the function CircularBufferBroadcast_Peek()         (consumer thread)
+      5) To release data after reading,                    call the function CircularBufferBroadcast_Consume()      (consumer thread)
+
+    + A new consumer starts reading at the current rear:r, it does not see data which was en-queued before registration.
+**/
+
+#include "circularBuffer_broadcast.h"
+
+
+/**
+  * @brief  CircularBufferBroadcast_Init() : This function is used to "initialize" a broadcast circular buffer struct.
+  * @param  targetBuf      : target circular buffer
+  * @param  pBuf           : pointer of storage buffer array
+  * @param  SetElementSize : size of each element (bytes)
+  * @param  SetBufferSize  : size of buffer (elements)
+  * @retval None
+  */
+void CircularBufferBroadcast_Init(circularBufferBroadcast_TypeDef *targetBuf, void *pBuf, int8_t SetElementSize, int32_t SetBufferSize)
+{
+    uint32_t InputByteSize;
+    uint8_t  i;
+
+    targetBuf->buf = pBuf;
+    targetBuf->bufferSize  = SetBufferSize;
+    targetBuf->elementSize = SetElementSize;
+    atomic_init(&targetBuf->r, 0);
+    targetBuf->minF = 0;
+    for(i=0; i<CIRCULAR_BUFFER_BROADCAST_MAX_CONSUMERS; i++)
+    {
+        atomic_init(&targetBuf->cursor[i].f, 0);
+        atomic_init(&targetBuf->cursor[i].active, 0);
+    }
+    InputByteSize = (targetBuf->elementSize)*(targetBuf->bufferSize);
+    memset(targetBuf->buf, 0, InputByteSize);
+}
+
+/**
+  * @brief  CircularBufferBroadcast_IsValidId() : Check a consumer id before it is used as index of cursor[] (-1 of a failed AddConsumer() is invalid).
+  */
+static inline uint8_t CircularBufferBroadcast_IsValidId(int8_t consumerId)
+{
+    return (consumerId >= 0) && (consumerId < CIRCULAR_BUFFER_BROADCAST_MAX_CONSUMERS);
+}
+
+/**
+  * @brief  CircularBufferBroadcast_AddConsumer() : This function is used to register a new consumer cursor.
+  *                                                 Must be called from the producer thread (or before the producer starts).
+  * @param  targetBuf : target circular buffer
+  * @retval consumer id (0 to CIRCULAR_BUFFER_BROADCAST_MAX_CONSUMERS-1)
+  *         -1 -> no free cursor
+  */
+int8_t CircularBufferBroadcast_AddConsumer(circularBufferBroadcast_TypeDef *targetBuf)
+{
+    uint8_t i;
+
+    for(i=0; i<CIRCULAR_BUFFER_BROADCAST_MAX_CONSUMERS; i++)
+    {
+        if(atomic_load_explicit(&targetBuf->cursor[i].active, memory_order_acquire) == 0)
+        {
+            atomic_store_explicit(&targetBuf->cursor[i].f, atomic_load_explicit(&targetBuf->r, memory_order_relaxed), memory_order_relaxed);
+            atomic_store_explicit(&targetBuf->cursor[i].active, 1, memory_order_release);
+            return (int8_t)i;
+        }
+    }
+    return -1;
+}
+
+/**
+  * @brief  CircularBufferBroadcast_RemoveConsumer() : This function is used to unregister a consumer cursor.
+  *                                                    The producer is not held back by this cursor anymore.
+  * @param  targetBuf  : target circular buffer
+  * @param  consumerId : consumer id from CircularBufferBroadcast_AddConsumer(), an invalid id is ignored
+  * @retval None
+  */
+void CircularBufferBroadcast_RemoveConsumer(circularBufferBroadcast_TypeDef *targetBuf, int8_t consumerId)
+{
+    if(!CircularBufferBroadcast_IsValidId(consumerId))      return;
+
+    atomic_store_explicit(&targetBuf->cursor[consumerId].active, 0, memory_order_release);
+}
+
+/**
+  * @brief  CircularBufferBroadcast_Enqueue() : This function is used to "En-queue" an input data into a broadcast circular buffer.
+  *                                            Must be called from the producer thread only.
+  *
+  *                                            Warning! : Elements which do not fit into the space released by the slowest consumer are not en-queued.
+  *                                                       If there is no registered consumer, data is en-queued and dropped right away.
+  * @param  targetBuf    : target circular buffer
+  * @param  enqueueData  : enqueued data pointer
+  * @param  enqueueSize  : size of enqueued data (#of element)
+  * @retval number of en-queued elements
+  */
+uint32_t CircularBufferBroadcast_Enqueue(circularBufferBroadcast_TypeDef *targetBuf, const void *enqueueData, uint32_t enqueueSize)
+{
+    uint64_t rear;
+    uint64_t front;
+    uint32_t freeSize;
+    uint32_t index;
+    uint32_t firstSize;
+    uint8_t  i;
+
+    rear = atomic_load_explicit(&targetBuf->r, memory_order_relaxed);
+
+    /* Refresh the slowest cursor only when the cached one does not leave enough space */
+    freeSize = (uint32_t)targetBuf->bufferSize - (uint32_t)(rear - targetBuf->minF);
+    if(enqueueSize > freeSize)
+    {
+        targetBuf->minF = rear;
+        for(i=0; i<CIRCULAR_BUFFER_BROADCAST_MAX_CONSUMERS; i++)
+        {
+            if(atomic_load_explicit(&targetBuf->cursor[i].active, memory_order_acquire))
+            {
+                front = atomic_load_explicit(&targetBuf->cursor[i].f, memory_order_acquire);
+                if(front < targetBuf->minF)     targetBuf->minF = front;
+            }
+        }
+        freeSize = (uint32_t)targetBuf->bufferSize - (uint32_t)(rear - targetBuf->minF);
+        if(enqueueSize > freeSize)      enqueueSize = freeSize;
+    }
+    if(enqueueSize == 0)            return 0;
+
+    index = (uint32_t)(rear % (uint64_t)targetBuf->bufferSize);
+    if(index + enqueueSize <= (uint32_t)targetBuf->bufferSize)
+    {
+        /* Not wrapping : copy only 1 section */
+        memcpy((void *)((uint8_t *)(targetBuf->buf) + targetBuf->elementSize*index), enqueueData, targetBuf->elementSize*enqueueSize);
+    }
+    else
+    {
+        /* Wrapping : copy with 2 sections */
+        firstSize = (uint32_t)targetBuf->bufferSize - index;
+        memcpy((void *)((uint8_t *)(targetBuf->buf) + targetBuf->elementSize*index), enqueueData, targetBuf->elementSize*firstSize);
+        memcpy(targetBuf->buf, (const void *)((const uint8_t *)(enqueueData) + targetBuf->elementSize*firstSize), targetBuf->elementSize*(enqueueSize - firstSize));
+    }
+
+    /* Publish the new elements to all consumers */
+    atomic_store_explicit(&targetBuf->r, rear + enqueueSize, memory_order_release);
+
+    return enqueueSize;
+}
+
+/**
+  * @brief  CircularBufferBroadcast_GetCount() : This function is used to get the number of unread elements of a consumer.
+  * @param  targetBuf  : target circular buffer
+  * @param  consumerId : consumer id from CircularBufferBroadcast_AddConsumer()
+  * @retval number of unread elements, 0 -> also for an invalid id
+  */
+uint32_t CircularBufferBroadcast_GetCount(circularBufferBroadcast_TypeDef *targetBuf, int8_t consumerId)
+{
+    uint64_t front;
+    uint64_t rear;
+
+    if(!CircularBufferBroadcast_IsValidId(consumerId))      return 0;
+
+    front = atomic_load_explicit(&targetBuf->cursor[consumerId].f, memory_order_relaxed);
+    rear  = atomic_load_explicit(&targetBuf->r, memory_order_acquire);
+    return (uint32_t)(rear - front);
+}
+
+/**
+  * @brief  CircularBufferBroadcast_Peek() : This function is used to get the unread region of a consumer without copying.
+  *                                         The region is described by 2 spans, span[1].size is 0 if the region is not wrapping.
+  *                                         Data in spans is valid (and must not be modified) until CircularBufferBroadcast_Consume() is called.
+  * @param  targetBuf  : target circular buffer
+  * @param  consumerId : consumer id from CircularBufferBroadcast_AddConsumer()
+  * @param  span       : output array of 2 spans
+  * @retval number of unread elements (span[0].size + span[1].size), 0 -> also for an invalid id
+  */
+uint32_t CircularBufferBroadcast_Peek(circularBufferBroadcast_TypeDef *targetBuf, int8_t consumerId, circularBufferSpan_TypeDef span[2])
+{
+    uint32_t usedSize;
+    uint32_t index;
+
+    if(!CircularBufferBroadcast_IsValidId(consumerId))
+    {
+        span[0].data = targetBuf->buf;
+        span[0].size = 0;
+        span[1].data = targetBuf->buf;
+        span[1].size = 0;
+        return 0;
+    }
+
+    usedSize = CircularBufferBroadcast_GetCount(targetBuf, consumerId);
+    index    = (uint32_t)(atomic_load_explicit(&targetBuf->cursor[consumerId].f, memory_order_relaxed) % (uint64_t)targetBuf->bufferSize);
+
+    span[0].data = (void *)((uint8_t *)(targetBuf->buf) + targetBuf->elementSize*index);
+    if(index + usedSize <= (uint32_t)targetBuf->bufferSize)
+    {
+        span[0].size = usedSize;
+        span[1].data = targetBuf->buf;
+        span[1].size = 0;
+    }
+    else
+    {
+        span[0].size = (uint32_t)targetBuf->bufferSize - index;
+        span[1].data = targetBuf->buf;
+        span[1].size = usedSize - span[0].size;
+    }
+    return usedSize;
+}
+
+/**
+  * @brief  CircularBufferBroadcast_Consume() : This function is used to move the front cursor of a consumer after reading.
+  * @param  targetBuf   : target circular buffer
+  * @param  consumerId  : consumer id from CircularBufferBroadcast_AddConsumer()
+  * @param  consumeSize : number of elements to release (limited to number of unread elements), an invalid id is ignored
+  * @retval None
+  */
+void CircularBufferBroadcast_Consume(circularBufferBroadcast_TypeDef *targetBuf, int8_t consumerId, uint32_t consumeSize)
+{
+    uint64_t front;
+    uint32_t usedSize;
+
+    if(!CircularBufferBroadcast_IsValidId(consumerId))      return;
+
+    front    = atomic_load_explicit(&targetBuf->cursor[consumerId].f, memory_order_relaxed);
+    usedSize = CircularBufferBroadcast_GetCount(targetBuf, consumerId);
+    if(consumeSize > usedSize)      consumeSize = usedSize;
+
+    /* Release the slots, the producer may overwrite them when this is the slowest cursor */
+    atomic_store_explicit(&targetBuf->cursor[consumerId].f, front + consumeSize, memory_order_release);
+}
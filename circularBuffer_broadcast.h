@@ -0,0 +1,76 @@
+/**
+  * circularBuffer_broadcast.h - lock-free broadcast circular buffer (1 producer, N consumers) in C.
+  *
+  * To the extent possible under law, the author(s) have dedicated all
+  * copyright and related and neighboring rights to this software to
+  * the public domain worldwide. This software is distributed without
+  * any warranty.
+  *
+  */
+
+#ifndef  __CIRCULARBUFFER_BROADCAST_H
+#define  __CIRCULARBUFFER_BROADCAST_H
+
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdatomic.h>
+
+#include "circularBuffer.h"
+
+/* Maximum number of registered consumers per broadcast buffer */
+#define     CIRCULAR_BUFFER_BROADCAST_MAX_CONSUMERS     8
+
+typedef struct {
+
+    _Alignas(CIRCULAR_BUFFER_CACHE_LINE_SIZE)
+    _Atomic uint64_t    f;              //front of this consumer (total number of consumed elements)
+    _Atomic uint8_t     active;         //1 -> registered, 0 -> free slot
+
+} circularBufferBroadcastCursor_TypeDef;
+
+typedef struct {
+
+    /* Producer cache line : written by producer thread only */
+    _Alignas(CIRCULAR_BUFFER_CACHE_LINE_SIZE)
+    _Atomic uint64_t    r;              //rear (total number of enqueued elements)
+    uint64_t            minF;           //producer's copy of the slowest front, refreshed when buffer looks full
+
+    /* Consumer cursors : each cursor is written by its own consumer thread only */
+    circularBufferBroadcastCursor_TypeDef   cursor[CIRCULAR_BUFFER_BROADCAST_MAX_CONSUMERS];
+
+    /* Read-only after CircularBufferBroadcast_Init() */
+    _Alignas(CIRCULAR_BUFFER_CACHE_LINE_SIZE)
+    void                *buf;           //pointer of 1-D data array
+    int32_t             bufferSize;     //buffer size (elements)
+    int8_t              elementSize;    //size per element (bytes)
+
+} circularBufferBroadcast_TypeDef;
+
+/* Function Prototyping for circularBuffer_broadcast.h */
+void     CircularBufferBroadcast_Init           (circularBufferBroadcast_TypeDef *targetBuf,
+                                                 void *pBuf,
+                                                 int8_t SetElementSize,
+                                                 int32_t SetBufferSize);
+
+int8_t   CircularBufferBroadcast_AddConsumer    (circularBufferBroadcast_TypeDef *targetBuf);
+void     CircularBufferBroadcast_RemoveConsumer (circularBufferBroadcast_TypeDef *targetBuf,
+                                                 int8_t consumerId);
+
+uint32_t CircularBufferBroadcast_Enqueue        (circularBufferBroadcast_TypeDef *targetBuf,
+                                                 const void *enqueueData,
+                                                 uint32_t enqueueSize);
+
+uint32_t CircularBufferBroadcast_Peek           (circularBufferBroadcast_TypeDef *targetBuf,
+                                                 int8_t consumerId,
+                                                 circularBufferSpan_TypeDef span[2]);
+
+void     CircularBufferBroadcast_Consume        (circularBufferBroadcast_TypeDef *targetBuf,
+                                                 int8_t consumerId,
+                                                 uint32_t consumeSize);
+
+uint32_t CircularBufferBroadcast_GetCount       (circularBufferBroadcast_TypeDef *targetBuf,
+                                                 int8_t consumerId);
+
+#endif
@@ -0,0 +1,374 @@
+/**
+  * circularBuffer_convert.c - type-converting de-queue (int16/int24/int32 to float) for circular buffer in C.
+  *
+  * To the extent possible under law, the author(s) have dedicated all
+  * copyright and related and neighboring rights to this software to
+  * the public domain worldwide. This software is distributed without
+  * any warranty.
+  *
+  * How to use this file:
+    --------------------
+    + CircularBuffer_DequeueFloat() de-queues raw ADC samples and writes them as float, multiplied by scale, in the same copy.
+      DSP_frameExtraction_GetNextFrameFloat() does the same for frame extraction (like DSP_frameExtraction_GetNextFrame()).
+      Each sample is read once from the buffer and written once as float, no separate conversion loop is needed.
+    + Use BUF_CONVERT_SCALE_xxx as scale for normalized float in [-1.0, 1.0).
+    + Conversion kernels :
+          x86    : AVX2 (selected at run time when the CPU supports it), otherwise SSE2
+          ARM    : NEON
+          others : scalar
+      AVX2 kernels are compiled with a target attribute, so no extra compiler flag is needed.
+**/
+
+#include "circularBuffer_convert.h"
+
+#include <stdatomic.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define CIRCULAR_BUFFER_CONVERT_X86
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+typedef void (*circularBufferConvertKernel)(float *dst, const uint8_t *src, uint32_t n, float scale);
+
+
+/**
+  * @brief  Scalar kernels, also used for the tail of SIMD kernels.
+  */
+static void CircularBuffer_ConvertInt16_Scalar(float *dst, const uint8_t *src, uint32_t n, float scale)
+{
+    uint32_t i;
+    int16_t  v;
+
+    for(i=0; i<n; i++)
+    {
+        memcpy(&v, src + 2*i, sizeof(v));
+        dst[i] = (float)v*scale;
+    }
+}
+
+static void CircularBuffer_ConvertInt24_Scalar(float *dst, const uint8_t *src, uint32_t n, float scale)
+{
+    uint32_t i;
+    int32_t  v;
+
+    for(i=0; i<n; i++)
+    {
+        /* little-endian 24-bit, sign-extended by arithmetic shift */
+        v = (int32_t)((uint32_t)src[3*i] << 8 | (uint32_t)src[3*i + 1] << 16 | (uint32_t)src[3*i + 2] << 24) >> 8;
+        dst[i] = (float)v*scale;
+    }
+}
+
+static void CircularBuffer_ConvertInt32_Scalar(float *dst, const uint8_t *src, uint32_t n, float scale)
+{
+    uint32_t i;
+    int32_t  v;
+
+    for(i=0; i<n; i++)
+    {
+        memcpy(&v, src + 4*i, sizeof(v));
+        dst[i] = (float)v*scale;
+    }
+}
+
+#if defined(CIRCULAR_BUFFER_CONVERT_X86)
+/**
+  * @brief  SSE2 kernels (x86 baseline).
+  */
+__attribute__((target("sse2")))
+static void CircularBuffer_ConvertInt16_SSE2(float *dst, const uint8_t *src, uint32_t n, float scale)
+{
+    __m128   s = _mm_set1_ps(scale);
+    uint32_t i;
+
+    for(i=0; i+8<=n; i+=8)
+    {
+        __m128i v  = _mm_loadu_si128((const __m128i *)(src + 2*i));
+        __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);     //sign-extend 4 x int16
+        __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+
+        _mm_storeu_ps(dst + i,     _mm_mul_ps(_mm_cvtepi32_ps(lo), s));
+        _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), s));
+    }
+    CircularBuffer_ConvertInt16_Scalar(dst + i, src + 2*i, n - i, scale);
+}
+
+__attribute__((target("sse2")))
+static void CircularBuffer_ConvertInt24_SSE2(float *dst, const uint8_t *src, uint32_t n, float scale)
+{
+    __m128   s = _mm_set1_ps(scale);
+    uint32_t i;
+
+    /* No byte shuffle in SSE2 : move each sample to lane 0 with a byte shift, then gather lanes 0 with unpacks.
+       Each iteration reads 16 bytes from sample i (4 samples and 4 bytes more), so keep 2 samples of margin */
+    for(i=0; i+6<=n; i+=4)
+    {
+        __m128i v   = _mm_loadu_si128((const __m128i *)(src + 3*i));
+        __m128i s01 = _mm_unpacklo_epi32(v, _mm_srli_si128(v, 3));                      //sample 0, sample 1 in lanes 0,1
+        __m128i s23 = _mm_unpacklo_epi32(_mm_srli_si128(v, 6), _mm_srli_si128(v, 9));   //sample 2, sample 3 in lanes 0,1
+
+        /* bytes 0..2 of each lane are the sample, shift the 4th byte out and sign-extend */
+        v = _mm_srai_epi32(_mm_slli_epi32(_mm_unpacklo_epi64(s01, s23), 8), 8);
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(v), s));
+    }
+    CircularBuffer_ConvertInt24_Scalar(dst + i, src + 3*i, n - i, scale);
+}
+
+__attribute__((target("sse2")))
+static void CircularBuffer_ConvertInt32_SSE2(float *dst, const uint8_t *src, uint32_t n, float scale)
+{
+    __m128   s = _mm_set1_ps(scale);
+    uint32_t i;
+
+    for(i=0; i+4<=n; i+=4)
+    {
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(_mm_loadu_si128((const __m128i *)(src + 4*i))), s));
+    }
+    CircularBuffer_ConvertInt32_Scalar(dst + i, src + 4*i, n - i, scale);
+}
+
+/**
+  * @brief  AVX2 kernels, selected at run time.
+  */
+__attribute__((target("avx2")))
+static void CircularBuffer_ConvertInt16_AVX2(float *dst, const uint8_t *src, uint32_t n, float scale)
+{
+    __m256   s = _mm256_set1_ps(scale);
+    uint32_t i;
+
+    for(i=0; i+8<=n; i+=8)
+    {
+        __m256i v = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)(src + 2*i)));
+
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(v), s));
+    }
+    CircularBuffer_ConvertInt16_Scalar(dst + i, src + 2*i, n - i, scale);
+}
+
+__attribute__((target("avx2")))
+static void CircularBuffer_ConvertInt24_AVX2(float *dst, const uint8_t *src, uint32_t n, float scale)
+{
+    /* Per 128-bit lane : 4 packed samples (12 bytes) -> bytes 1..3 of each int32, then shift right to sign-extend */
+    const __m256i shuffle = _mm256_setr_epi8(-1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11,
+                                             -1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11);
+    __m256   s = _mm256_set1_ps(scale);
+    uint32_t i;
+
+    /* Each iteration reads 28 bytes from sample i (16 bytes at 3*i + 12), so keep 2 samples of margin */
+    for(i=0; i+10<=n; i+=8)
+    {
+        __m256i v = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i *)(src + 3*i))),
+                                            _mm_loadu_si128((const __m128i *)(src + 3*i + 12)), 1);
+
+        v = _mm256_srai_epi32(_mm256_shuffle_epi8(v, shuffle), 8);
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(v), s));
+    }
+    CircularBuffer_ConvertInt24_Scalar(dst + i, src + 3*i, n - i, scale);
+}
+
+__attribute__((target("avx2")))
+static void CircularBuffer_ConvertInt32_AVX2(float *dst, const uint8_t *src, uint32_t n, float scale)
+{
+    __m256   s = _mm256_set1_ps(scale);
+    uint32_t i;
+
+    for(i=0; i+8<=n; i+=8)
+    {
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_loadu_si256((const __m256i *)(src + 4*i))), s));
+    }
+    CircularBuffer_ConvertInt32_Scalar(dst + i, src + 4*i, n - i, scale);
+}
+
+#elif defined(__ARM_NEON)
+/**
+  * @brief  NEON kernels.
+  */
+static void CircularBuffer_ConvertInt16_NEON(float *dst, const uint8_t *src, uint32_t n, float scale)
+{
+    uint32_t i;
+
+    for(i=0; i+8<=n; i+=8)
+    {
+        int16x8_t v = vld1q_s16((const int16_t *)(src + 2*i));
+
+        vst1q_f32(dst + i,     vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(v))), scale));
+        vst1q_f32(dst + i + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(v))), scale));
+    }
+    CircularBuffer_ConvertInt16_Scalar(dst + i, src + 2*i, n - i, scale);
+}
+
+static inline void CircularBuffer_ConvertInt24x8_NEON(float *dst, uint8x8_t low, uint8x8_t mid, uint8x8_t high, float scale)
+{
+    /* low 16 bits unsigned, high byte sign-extended : sample = (high << 16) | (mid << 8) | low */
+    uint16x8_t lo = vaddw_u8(vshll_n_u8(mid, 8), low);
+    int16x8_t  hi = vmovl_s8(vreinterpret_s8_u8(high));
+    int32x4_t  v0 = vorrq_s32(vshll_n_s16(vget_low_s16(hi), 16),  vreinterpretq_s32_u32(vmovl_u16(vget_low_u16(lo))));
+    int32x4_t  v1 = vorrq_s32(vshll_n_s16(vget_high_s16(hi), 16), vreinterpretq_s32_u32(vmovl_u16(vget_high_u16(lo))));
+
+    vst1q_f32(dst,     vmulq_n_f32(vcvtq_f32_s32(v0), scale));
+    vst1q_f32(dst + 4, vmulq_n_f32(vcvtq_f32_s32(v1), scale));
+}
+
+static void CircularBuffer_ConvertInt24_NEON(float *dst, const uint8_t *src, uint32_t n, float scale)
+{
+    uint32_t i;
+
+    for(i=0; i+16<=n; i+=16)
+    {
+        /* de-interleave 16 packed samples (48 bytes) into low, middle and high byte planes */
+        uint8x16x3_t b = vld3q_u8(src + 3*i);
+
+        CircularBuffer_ConvertInt24x8_NEON(dst + i,     vget_low_u8(b.val[0]),  vget_low_u8(b.val[1]),  vget_low_u8(b.val[2]),  scale);
+        CircularBuffer_ConvertInt24x8_NEON(dst + i + 8, vget_high_u8(b.val[0]), vget_high_u8(b.val[1]), vget_high_u8(b.val[2]), scale);
+    }
+    CircularBuffer_ConvertInt24_Scalar(dst + i, src + 3*i, n - i, scale);
+}
+
+static void CircularBuffer_ConvertInt32_NEON(float *dst, const uint8_t *src, uint32_t n, float scale)
+{
+    uint32_t i;
+
+    for(i=0; i+4<=n; i+=4)
+    {
+        vst1q_f32(dst + i, vmulq_n_f32(vcvtq_f32_s32(vld1q_s32((const int32_t *)(src + 4*i))), scale));
+    }
+    CircularBuffer_ConvertInt32_Scalar(dst + i, src + 4*i, n - i, scale);
+}
+#endif
+
+/**
+  * @brief  CircularBuffer_GetConvertKernel() : Kernel of a source type for this CPU, CPU features are checked once.
+  */
+static circularBufferConvertKernel CircularBuffer_GetConvertKernel(uint8_t sourceType)
+{
+#if defined(CIRCULAR_BUFFER_CONVERT_X86)
+    static _Atomic int hasAVX2 = -1;
+    int                avx2 = atomic_load_explicit(&hasAVX2, memory_order_relaxed);
+
+    if(avx2 < 0)
+    {
+        __builtin_cpu_init();
+        avx2 = __builtin_cpu_supports("avx2") ? 1 : 0;
+        atomic_store_explicit(&hasAVX2, avx2, memory_order_relaxed);
+    }
+    switch(sourceType)
+    {
+        case BUF_CONVERT_INT16 : return avx2 ? CircularBuffer_ConvertInt16_AVX2 : CircularBuffer_ConvertInt16_SSE2;
+        case BUF_CONVERT_INT24 : return avx2 ? CircularBuffer_ConvertInt24_AVX2 : CircularBuffer_ConvertInt24_SSE2;
+        case BUF_CONVERT_INT32 : return avx2 ? CircularBuffer_ConvertInt32_AVX2 : CircularBuffer_ConvertInt32_SSE2;
+        default                : return NULL;
+    }
+#elif defined(__ARM_NEON)
+    switch(sourceType)
+    {
+        case BUF_CONVERT_INT16 : return CircularBuffer_ConvertInt16_NEON;
+        case BUF_CONVERT_INT24 : return CircularBuffer_ConvertInt24_NEON;
+        case BUF_CONVERT_INT32 : return CircularBuffer_ConvertInt32_NEON;
+        default                : return NULL;
+    }
+#else
+    switch(sourceType)
+    {
+        case BUF_CONVERT_INT16 : return CircularBuffer_ConvertInt16_Scalar;
+        case BUF_CONVERT_INT24 : return CircularBuffer_ConvertInt24_Scalar;
+        case BUF_CONVERT_INT32 : return CircularBuffer_ConvertInt32_Scalar;
+        default                : return NULL;
+    }
+#endif
+}
+
+/**
+  * @brief  CircularBuffer_SourceSize() : Element size (bytes) of a source type, 0 -> unknown type.
+  */
+static inline int8_t CircularBuffer_SourceSize(uint8_t sourceType)
+{
+    static const int8_t sourceSize[] = {2, 3, 4};
+
+    return (sourceType <= BUF_CONVERT_INT32) ? sourceSize[sourceType] : 0;
+}
+
+/**
+  * @brief  CircularBuffer_ConvertToFloat() : This function is used to convert samples to float and scale them (dst[i] = src[i]*scale).
+  * @param  dst        : output float array
+  * @param  src        : input samples
+  * @param  n          : number of samples
+  * @param  sourceType : BUF_CONVERT_INT16, BUF_CONVERT_INT24 or BUF_CONVERT_INT32
+  * @param  scale      : multiplier, e.g. BUF_CONVERT_SCALE_INT32
+  * @retval None
+  */
+void CircularBuffer_ConvertToFloat(float *dst, const void *src, uint32_t n, uint8_t sourceType, float scale)
+{
+    circularBufferConvertKernel kernel = CircularBuffer_GetConvertKernel(sourceType);
+
+    if(kernel != NULL)      kernel(dst, (const uint8_t *)src, n, scale);
+}
+
+/**
+  * @brief  CircularBuffer_DequeueFloat() : This function is used to "De-queue" samples from a circular buffer as scaled float.
+  *                                        When dequeueSize is larger than number of elements, only the available elements are de-queued.
+  *                                        De-queued data is cleared according to the scrub policy of buffer.
+  * @param  targetBuf    : target circular buffer (elementSize of sourceType)
+  * @param  dequeueData  : output float array
+  * @param  dequeueSize  : size of dequeued data (#of element)
+  * @param  sourceType   : BUF_CONVERT_INT16, BUF_CONVERT_INT24 or BUF_CONVERT_INT32
+  * @param  scale        : multiplier, e.g. BUF_CONVERT_SCALE_INT32
+  * @retval number of de-queued elements, 0 -> also if sourceType does not match elementSize of buffer
+  */
+uint32_t CircularBuffer_DequeueFloat(circularBuffer_TypeDef *targetBuf, float *dequeueData, uint32_t dequeueSize, uint8_t sourceType, float scale)
+{
+    circularBufferSpan_TypeDef  span[2];
+    circularBufferConvertKernel kernel = CircularBuffer_GetConvertKernel(sourceType);
+
+    if((kernel == NULL) || (targetBuf->elementSize != CircularBuffer_SourceSize(sourceType)))     return 0;
+
+    /* Convert with 1 section, or 2 sections when wrapping */
+    dequeueSize = CircularBuffer_Peek(targetBuf, span, dequeueSize);
+    kernel(dequeueData, (const uint8_t *)span[0].data, span[0].size, scale);
+    kernel(dequeueData + span[0].size, (const uint8_t *)span[1].data, span[1].size, scale);
+
+    /* CircularBuffer_Consume() clears only for BUF_SCRUB_SECURE */
+    if(targetBuf->scrubPolicy == BUF_SCRUB_ZERO)
+    {
+        memset(span[0].data, 0, targetBuf->elementSize*span[0].size);
+        memset(span[1].data, 0, targetBuf->elementSize*span[1].size);
+    }
+    return CircularBuffer_Consume(targetBuf, dequeueSize);
+}
+
+/**
+  * @brief  DSP_frameExtraction_GetNextFrameFloat() : This function is used to extract the next frame from a circular buffer as scaled float.
+  *                                                  Same framing as DSP_frameExtraction_GetNextFrame(), the overlap section stays in buffer.
+  *
+  *                                                  Warning! : Do not mix with DSP_frameExtraction_IsNextFrameReady() or CircularBuffer_Dequeue()
+  *                                                             on the same buffer.
+  * @param  targetBuf    : circular buffer structure
+  * @param  targetFrame  : frame structure (elementSize of sourceType, frame array is not used)
+  * @param  pFrame       : output float frame (frameSize elements)
+  * @param  sourceType   : BUF_CONVERT_INT16, BUF_CONVERT_INT24 or BUF_CONVERT_INT32
+  * @param  scale        : multiplier, e.g. BUF_CONVERT_SCALE_INT32
+  * @retval FRAME_IS_READY      -> ready, pFrame holds the next frame
+  *         FRAME_IS_NOT_READY  -> not ready
+  *         FRAME_ERROR         -> error
+  */
+dspFrame_result DSP_frameExtraction_GetNextFrameFloat(circularBuffer_TypeDef *targetBuf, dspFrame_TypeDef *targetFrame, float *pFrame,
+                                                      uint8_t sourceType, float scale)
+{
+    circularBufferSpan_TypeDef  span[2];
+    circularBufferConvertKernel kernel = CircularBuffer_GetConvertKernel(sourceType);
+    dspFrame_result             result;
+
+    if((kernel == NULL) || (targetBuf->elementSize != CircularBuffer_SourceSize(sourceType)))
+    {
+        return FRAME_ERROR;	//error
+    }
+
+    // same framing and hooks as DSP_frameExtraction_GetNextFrame(), only the output is converted
+    result = DSP_frameExtraction_PeekNextFrame(targetBuf, targetFrame, span);
+    if(result != FRAME_IS_READY)    return result;
+
+    kernel(pFrame, (const uint8_t *)span[0].data, span[0].size, scale);
+    kernel(pFrame + span[0].size, (const uint8_t *)span[1].data, span[1].size, scale);
+    return FRAME_IS_READY;
+}
@@ -0,0 +1,51 @@
+/**
+  * circularBuffer_convert.h - type-converting de-queue (int16/int24/int32 to float) for circular buffer in C.
+  *
+  * To the extent possible under law, the author(s) have dedicated all
+  * copyright and related and neighboring rights to this software to
+  * the public domain worldwide. This software is distributed without
+  * any warranty.
+  *
+  */
+
+#ifndef  __CIRCULARBUFFER_CONVERT_H
+#define  __CIRCULARBUFFER_CONVERT_H
+
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "circularBuffer.h"
+#include "dsp_frame.h"
+
+/* Define of source sample types (element size of buffer must match) */
+#define     BUF_CONVERT_INT16               0       //int16_t, elementSize 2
+#define     BUF_CONVERT_INT24               1       //packed little-endian 24-bit, elementSize 3
+#define     BUF_CONVERT_INT32               2       //int32_t (_RING_BUFFER_DATA_TYPE), elementSize 4
+
+/* Scale which maps full range of a source type to [-1.0, 1.0) */
+#define     BUF_CONVERT_SCALE_INT16         (1.0f/32768.0f)
+#define     BUF_CONVERT_SCALE_INT24         (1.0f/8388608.0f)
+#define     BUF_CONVERT_SCALE_INT32         (1.0f/2147483648.0f)
+
+/* Function Prototyping for circularBuffer_convert.h */
+void     CircularBuffer_ConvertToFloat  (float *dst,
+                                         const void *src,
+                                         uint32_t n,
+                                         uint8_t sourceType,
+                                         float scale);
+
+uint32_t CircularBuffer_DequeueFloat    (circularBuffer_TypeDef *targetBuf,
+                                         float *dequeueData,
+                                         uint32_t dequeueSize,
+                                         uint8_t sourceType,
+                                         float scale);
+
+dspFrame_result DSP_frameExtraction_GetNextFrameFloat(circularBuffer_TypeDef *targetBuf,
+                                                      dspFrame_TypeDef *targetFrame,
+                                                      float *pFrame,
+                                                      uint8_t sourceType,
+                                                      float scale);
+
+#endif
@@ -0,0 +1,140 @@
+/**
+  * circularBuffer_event.c - eventfd readiness notification for circular buffer in C (Linux).
+  *
+  * To the extent possible under law, the author(s) have dedicated all
+  * copyright and related and neighboring rights to this software to
+  * the public domain worldwide. This software is distributed without
+  * any warranty.
+  *
+  * How to use this file:
+    --------------------
+    + CircularBuffer_EventFd_Init() attaches an eventfd to a buffer. The eventfd becomes readable when
+      en-queue (or commit) makes the number of elements in buffer reach the configured level, so a
+      consumer can sleep in poll()/epoll_wait() together with its other file descriptors :
+
+          CircularBuffer_EventFd_Init(&myEvent, &myRingBuffer, 256);
+          ev.events = EPOLLIN;
+          epoll_ctl(epfd, EPOLL_CTL_ADD, myEvent.fd, &ev);
+
+    + CircularBuffer_EventFd_AttachFrame() makes the level follow a frame extraction instead : the eventfd
+      becomes readable when the next full frame of targetFrame is available in buffer.
+    + The eventfd is signalled on the edge only (count crosses the level), so after a wake-up the consumer
+      calls CircularBuffer_EventFd_Ack(), then extracts frames until FRAME_IS_NOT_READY (or de-queues
+      below the level) before it waits again.
+    + A buffer without an attached event (default) pays one NULL test per en-queue.
+    + The eventfd is written from the producer context, buffer itself is still not thread-safe.
+**/
+
+#if defined(__linux__)
+#define _GNU_SOURCE
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif
+
+#include "circularBuffer_event.h"
+
+
+/**
+  * @brief  CircularBuffer_EventFd_Signal() : Make the eventfd readable (callback from en-queue of buffer).
+  */
+static void CircularBuffer_EventFd_Signal(circularBufferEvent_TypeDef *event)
+{
+#if defined(__linux__)
+    uint64_t one = 1;
+
+    /* EAGAIN only when counter is saturated, which is still readable */
+    if(write(event->fd, &one, sizeof(one)) < 0)     return;
+#else
+    (void)event;
+#endif
+}
+
+/**
+  * @brief  CircularBuffer_EventFd_Init() : This function is used to attach an eventfd to a circular buffer.
+  * @param  event     : event struct, must stay valid while it is attached
+  * @param  targetBuf : target circular buffer
+  * @param  level     : number of elements in buffer which makes event->fd readable
+  * @retval 0 -> success
+  *         1 -> error, eventfd is not available
+  */
+uint8_t CircularBuffer_EventFd_Init(circularBufferEvent_TypeDef *event, circularBuffer_TypeDef *targetBuf, uint32_t level)
+{
+#if defined(__linux__)
+    event->fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if(event->fd < 0)       return 1;
+
+    event->level     = level;
+    event->fromFrame = 0;
+    event->signal    = CircularBuffer_EventFd_Signal;
+    targetBuf->event = event;
+
+    /* level may be reached already */
+    if(CircularBuffer_GetCount(targetBuf) >= level)     CircularBuffer_EventFd_Signal(event);
+    return 0;
+#else
+    (void)event;
+    (void)targetBuf;
+    (void)level;
+    return 1;
+#endif
+}
+
+/**
+  * @brief  CircularBuffer_EventFd_DeInit() : This function is used to detach and close the eventfd of a circular buffer.
+  * @param  event     : event struct from CircularBuffer_EventFd_Init()
+  * @param  targetBuf : target circular buffer
+  * @retval None
+  */
+void CircularBuffer_EventFd_DeInit(circularBufferEvent_TypeDef *event, circularBuffer_TypeDef *targetBuf)
+{
+    if(targetBuf->event == event)   targetBuf->event = NULL;
+#if defined(__linux__)
+    if(event->fd >= 0)      close(event->fd);
+#endif
+    event->fd = -1;
+}
+
+/**
+  * @brief  CircularBuffer_EventFd_AttachFrame() : This function is used to make the eventfd of a buffer readable when the next frame is ready.
+  * @param  targetBuf   : target circular buffer, with an event from CircularBuffer_EventFd_Init()
+  * @param  targetFrame : frame extraction struct which reads from targetBuf
+  * @retval None
+  */
+void CircularBuffer_EventFd_AttachFrame(circularBuffer_TypeDef *targetBuf, dspFrame_TypeDef *targetFrame)
+{
+    circularBufferEvent_TypeDef *event = targetBuf->event;
+
+    if(event == NULL)       return;
+
+    if(targetFrame->firstFrameCompleteFlag != FIRST_FRAME_IS_COMPLETED)
+    {
+        event->level = targetFrame->frameSize;
+    }
+    else if(targetFrame->pendingHop > 0)
+    {
+        event->level = targetFrame->frameSize + targetFrame->pendingHop;
+    }
+    else
+    {
+        event->level = targetFrame->frameSize - targetFrame->overlap;
+    }
+    event->fromFrame = 1;
+
+    if(CircularBuffer_GetCount(targetBuf) >= event->level)      event->signal(event);
+}
+
+/**
+  * @brief  CircularBuffer_EventFd_Ack() : This function is used to reset the eventfd after a wake-up.
+  * @param  event : event struct from CircularBuffer_EventFd_Init()
+  * @retval None
+  */
+void CircularBuffer_EventFd_Ack(circularBufferEvent_TypeDef *event)
+{
+#if defined(__linux__)
+    uint64_t counter;
+
+    if(read(event->fd, &counter, sizeof(counter)) < 0)      return;
+#else
+    (void)event;
+#endif
+}
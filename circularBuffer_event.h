@@ -0,0 +1,35 @@
+/**
+  * circularBuffer_event.h - eventfd readiness notification for circular buffer in C (Linux).
+  *
+  * To the extent possible under law, the author(s) have dedicated all
+  * copyright and related and neighboring rights to this software to
+  * the public domain worldwide. This software is distributed without
+  * any warranty.
+  *
+  */
+
+#ifndef  __CIRCULARBUFFER_EVENT_H
+#define  __CIRCULARBUFFER_EVENT_H
+
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "circularBuffer.h"
+#include "dsp_frame.h"
+
+/* Function Prototyping for circularBuffer_event.h */
+uint8_t CircularBuffer_EventFd_Init         (circularBufferEvent_TypeDef *event,
+                                             circularBuffer_TypeDef *targetBuf,
+                                             uint32_t level);
+
+void    CircularBuffer_EventFd_DeInit       (circularBufferEvent_TypeDef *event,
+                                             circularBuffer_TypeDef *targetBuf);
+
+void    CircularBuffer_EventFd_AttachFrame  (circularBuffer_TypeDef *targetBuf,
+                                             dspFrame_TypeDef *targetFrame);
+
+void    CircularBuffer_EventFd_Ack          (circularBufferEvent_TypeDef *event);
+
+#endif
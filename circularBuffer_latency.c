@@ -0,0 +1,187 @@
+/**
+  * circularBuffer_latency.c - enqueue-to-frame latency histogram for circular buffer in C.
+  *
+  * To the extent possible under law, the author(s) have dedicated all
+  * copyright and related and neighboring rights to this software to
+  * the public domain worldwide. This software is distributed without
+  * any warranty.
+  *
+  * How to use this file:
+    --------------------
+    + Build every file with -DCIRCULAR_BUFFER_LATENCY to enable it (the flag changes circularBuffer_TypeDef, so it must
+      be the same for all files). Without the flag, this file only includes its header and the hooks in circularBuffer.c
+      and dsp_frame.c compile to nothing.
+    + Attach a tracker to a buffer with CircularBuffer_SetLatency(). Each en-queue (or commit) stores the position and
+      time of its block. Each frame returned by DSP_frameExtraction_IsNextFrameReady() or DSP_frameExtraction_GetNextFrame()
+      records one latency : time since the oldest element which is new in that frame was en-queued.
+    + Read the result with CircularBuffer_GetLatencyPercentile(), e.g. quantile 0.5, 0.99 and 0.999 for p50/p99/p999.
+      Value is the upper bound of its histogram bucket.
+    + Times are from CLOCK_MONOTONIC (nanoseconds). With -DCIRCULAR_BUFFER_LATENCY_TSC on x86, the TSC is read instead
+      (cycles, cheaper to read, needs an invariant TSC).
+    + If more than CIRCULAR_BUFFER_LATENCY_MARKS blocks are in buffer, a new block gets no mark and is counted with the
+      time of the block before it, so latency is over-estimated, never under-estimated.
+**/
+
+#if defined(__linux__)
+#define _GNU_SOURCE
+#elif defined(__unix__) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+/* Included with or without the flag, so that this file is never an empty translation unit */
+#include "circularBuffer_latency.h"
+
+#if defined(CIRCULAR_BUFFER_LATENCY)
+
+#include <time.h>
+
+#if defined(CIRCULAR_BUFFER_LATENCY_TSC) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#endif
+
+
+/**
+  * @brief  CircularBuffer_SetLatency() : This function is used to attach a latency tracker to a circular buffer.
+  *                                       Histogram is cleared, elements already in buffer are not measured.
+  * @param  targetBuf : target circular buffer
+  * @param  latency   : tracker, must stay valid while it is attached, NULL -> detach
+  * @retval None
+  */
+void CircularBuffer_SetLatency(circularBuffer_TypeDef *targetBuf, circularBufferLatency_TypeDef *latency)
+{
+    if(latency != NULL)
+    {
+        memset(latency, 0, sizeof(circularBufferLatency_TypeDef));
+        latency->rearPos = CircularBuffer_GetCount(targetBuf);
+    }
+    targetBuf->latency = latency;
+}
+
+/**
+  * @brief  CircularBuffer_LatencyNow() : This function is used to read the clock of latency tracker.
+  * @retval current time (nanoseconds, or TSC cycles with CIRCULAR_BUFFER_LATENCY_TSC)
+  */
+uint64_t CircularBuffer_LatencyNow(void)
+{
+#if defined(CIRCULAR_BUFFER_LATENCY_TSC) && (defined(__x86_64__) || defined(__i386__))
+    return __rdtsc();
+#else
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec*1000000000ULL + (uint64_t)now.tv_nsec;
+#endif
+}
+
+/**
+  * @brief  CircularBuffer_LatencyDropMarks() : Remove marks of blocks which are completely before position pos.
+  */
+static void CircularBuffer_LatencyDropMarks(circularBufferLatency_TypeDef *latency, uint64_t pos)
+{
+    while((latency->markCount > 1) && (latency->markPos[(latency->markHead + 1) % CIRCULAR_BUFFER_LATENCY_MARKS] <= pos))
+    {
+        latency->markHead = (latency->markHead + 1) % CIRCULAR_BUFFER_LATENCY_MARKS;
+        latency->markCount--;
+    }
+}
+
+/**
+  * @brief  CircularBuffer_LatencyMark() : This function is used to timestamp a block of addedSize elements, called after en-queue.
+  * @param  targetBuf : target circular buffer (with a tracker attached)
+  * @param  addedSize : number of en-queued elements
+  * @retval None
+  */
+void CircularBuffer_LatencyMark(circularBuffer_TypeDef *targetBuf, uint32_t addedSize)
+{
+    circularBufferLatency_TypeDef   *latency = targetBuf->latency;
+    uint32_t                        tail;
+
+    if(addedSize == 0)      return;
+
+    /* Front position is derived from the count, so de-queue, overwrite and flush need no hook */
+    CircularBuffer_LatencyDropMarks(latency, latency->rearPos + addedSize - CircularBuffer_GetCount(targetBuf));
+    if(latency->markCount < CIRCULAR_BUFFER_LATENCY_MARKS)
+    {
+        tail = (latency->markHead + latency->markCount) % CIRCULAR_BUFFER_LATENCY_MARKS;
+        latency->markPos[tail]  = latency->rearPos;
+        latency->markTime[tail] = CircularBuffer_LatencyNow();
+        latency->markCount++;
+    }
+    latency->rearPos += addedSize;
+}
+
+/**
+  * @brief  CircularBuffer_LatencyBucket() : Histogram bucket of a value.
+  */
+static uint32_t CircularBuffer_LatencyBucket(uint64_t value)
+{
+    uint32_t shift;
+
+    if(value < (1u << CIRCULAR_BUFFER_LATENCY_SUB_BITS))    return (uint32_t)value;
+
+    shift = 63 - (uint32_t)__builtin_clzll(value) - CIRCULAR_BUFFER_LATENCY_SUB_BITS;
+    return ((shift + 1) << CIRCULAR_BUFFER_LATENCY_SUB_BITS) + (uint32_t)((value >> shift) & ((1u << CIRCULAR_BUFFER_LATENCY_SUB_BITS) - 1));
+}
+
+/**
+  * @brief  CircularBuffer_LatencyFrame() : This function is used to record the latency of a frame, called when the frame is extracted.
+  * @param  targetBuf : target circular buffer (with a tracker attached)
+  * @param  offset    : position from front of the oldest element which is new in the frame
+  * @retval None
+  */
+void CircularBuffer_LatencyFrame(circularBuffer_TypeDef *targetBuf, uint32_t offset)
+{
+    circularBufferLatency_TypeDef   *latency = targetBuf->latency;
+    uint64_t                        pos = latency->rearPos - CircularBuffer_GetCount(targetBuf) + offset;
+    uint64_t                        value;
+
+    CircularBuffer_LatencyDropMarks(latency, pos);
+
+    /* No mark : element was in buffer before the tracker was attached */
+    if((latency->markCount == 0) || (latency->markPos[latency->markHead] > pos))     return;
+
+    value = CircularBuffer_LatencyNow() - latency->markTime[latency->markHead];
+    latency->bucket[CircularBuffer_LatencyBucket(value)]++;
+    latency->frames++;
+    if(value > latency->maxLatency)     latency->maxLatency = value;
+}
+
+/**
+  * @brief  CircularBuffer_GetLatencyPercentile() : This function is used to read a percentile of recorded frame latency.
+  * @param  latency  : latency tracker
+  * @param  quantile : 0.0 to 1.0 (0.5 -> p50, 0.99 -> p99, 0.999 -> p999)
+  * @retval latency at quantile (upper bound of its bucket, limited to the highest recorded latency), 0 -> no frame recorded
+  */
+uint64_t CircularBuffer_GetLatencyPercentile(circularBufferLatency_TypeDef *latency, double quantile)
+{
+    uint64_t rank;
+    uint64_t sum = 0;
+    uint64_t upper;
+    uint32_t i, shift;
+
+    if(latency->frames == 0)    return 0;
+
+    rank = (uint64_t)(quantile*(double)latency->frames + 0.999999);
+    if(rank == 0)                   rank = 1;
+    if(rank > latency->frames)      rank = latency->frames;
+
+    for(i=0; i<CIRCULAR_BUFFER_LATENCY_BUCKETS; i++)
+    {
+        sum += latency->bucket[i];
+        if(sum >= rank)     break;
+    }
+
+    if(i < (1u << CIRCULAR_BUFFER_LATENCY_SUB_BITS))
+    {
+        upper = i;
+    }
+    else
+    {
+        shift = (i >> CIRCULAR_BUFFER_LATENCY_SUB_BITS) - 1;
+        upper = ((uint64_t)((1u << CIRCULAR_BUFFER_LATENCY_SUB_BITS) + (i & ((1u << CIRCULAR_BUFFER_LATENCY_SUB_BITS) - 1))) << shift) + ((1ULL << shift) - 1);
+    }
+    if(upper > latency->maxLatency)     upper = latency->maxLatency;
+    return upper;
+}
+
+#endif
@@ -0,0 +1,76 @@
+/**
+  * circularBuffer_latency.h - enqueue-to-frame latency histogram for circular buffer in C.
+  *
+  * To the extent possible under law, the author(s) have dedicated all
+  * copyright and related and neighboring rights to this software to
+  * the public domain worldwide. This software is distributed without
+  * any warranty.
+  *
+  */
+
+#ifndef  __CIRCULARBUFFER_LATENCY_H
+#define  __CIRCULARBUFFER_LATENCY_H
+
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "circularBuffer.h"
+
+#if defined(CIRCULAR_BUFFER_LATENCY)
+
+/* Number of en-queued blocks with a timestamp, which can be in buffer at the same time */
+#ifndef CIRCULAR_BUFFER_LATENCY_MARKS
+#define     CIRCULAR_BUFFER_LATENCY_MARKS       256
+#endif
+
+/* Histogram buckets : values below 8 have their own bucket, then each power of two is split into 8 buckets (error < 12.5%) */
+#define     CIRCULAR_BUFFER_LATENCY_SUB_BITS    3
+#define     CIRCULAR_BUFFER_LATENCY_BUCKETS     ((64 - CIRCULAR_BUFFER_LATENCY_SUB_BITS + 1) << CIRCULAR_BUFFER_LATENCY_SUB_BITS)
+
+/* Latency tracker of a buffer, unit of all times is nanoseconds (CLOCK_MONOTONIC) or TSC cycles (CIRCULAR_BUFFER_LATENCY_TSC) */
+typedef struct circularBufferLatency {
+
+    uint64_t            markPos[CIRCULAR_BUFFER_LATENCY_MARKS];     //position of 1st element of each en-queued block
+    uint64_t            markTime[CIRCULAR_BUFFER_LATENCY_MARKS];    //en-queue time of each block
+    uint32_t            markHead;       //index of oldest mark
+    uint32_t            markCount;      //number of marks
+    uint64_t            rearPos;        //total en-queued elements since CircularBuffer_SetLatency()
+
+    uint64_t            bucket[CIRCULAR_BUFFER_LATENCY_BUCKETS];    //histogram of per-frame latency
+    uint64_t            frames;         //number of recorded frames
+    uint64_t            maxLatency;     //highest recorded latency
+
+} circularBufferLatency_TypeDef;
+
+/* Function Prototyping for circularBuffer_latency.h */
+void     CircularBuffer_SetLatency      (circularBuffer_TypeDef *targetBuf,
+                                         circularBufferLatency_TypeDef *latency);
+
+uint64_t CircularBuffer_LatencyNow      (void);
+
+void     CircularBuffer_LatencyMark     (circularBuffer_TypeDef *targetBuf,
+                                         uint32_t addedSize);
+
+void     CircularBuffer_LatencyFrame    (circularBuffer_TypeDef *targetBuf,
+                                         uint32_t offset);
+
+uint64_t CircularBuffer_GetLatencyPercentile(circularBufferLatency_TypeDef *latency,
+                                             double quantile);
+
+/* Hooks of en-queue and frame extraction, only a NULL test when no tracker is attached */
+#define     CIRCULAR_BUFFER_LATENCY_MARK(targetBuf, addedSize) \
+    do { if((targetBuf)->latency != NULL)    CircularBuffer_LatencyMark((targetBuf), (addedSize)); } while(0)
+#define     CIRCULAR_BUFFER_LATENCY_FRAME(targetBuf, offset) \
+    do { if((targetBuf)->latency != NULL)    CircularBuffer_LatencyFrame((targetBuf), (offset)); } while(0)
+
+#else
+
+/* Disabled : hooks compile away, buffer has no latency field */
+#define     CIRCULAR_BUFFER_LATENCY_MARK(targetBuf, addedSize)      do { } while(0)
+#define     CIRCULAR_BUFFER_LATENCY_FRAME(targetBuf, offset)        do { } while(0)
+
+#endif
+
+#endif
@@ -0,0 +1,111 @@
+/**
+  * circularBuffer_mirror.c - virtual-memory mirrored storage for circular buffer in C (Linux).
+  *
+  * To the extent possible under law, the author(s) have dedicated all
+  * copyright and related and neighboring rights to this software to
+  * the public domain worldwide. This software is distributed without
+  * any warranty.
+  *
+  * How to use this file:
+    --------------------
+    + CircularBuffer_InitMirror() allocates the storage array of a circular buffer by itself (no pBuf),
+      and maps the same physical pages twice, back to back:
+
+          virtual  : | buf[0] ... buf[N-1] | buf[0] ... buf[N-1] |
+          physical : |      memfd pages    |  same memfd pages   |
+
+      So, any region of up to N elements starting inside buf is contiguous in virtual memory.
+      En-queue and de-queue never split a memcpy() at the end of buffer, and a wrapped frame
+      can be read by one pointer with DSP_frameExtraction_GetNextFrame().
+    + The buffer is initialized in BUF_MODE_POW2, buffer size (bytes) must be a multiple of page size.
+    + Release the mapping with CircularBuffer_DeInitMirror().
+**/
+
+#if defined(__linux__)
+#define _GNU_SOURCE
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "circularBuffer_mirror.h"
+
+
+/**
+  * @brief  CircularBuffer_InitMirror() : This function is used to "initialize" a FIFO circular buffer struct with mirrored storage.
+  * @param  targetBuf      : target circular buffer
+  * @param  SetElementSize : size of each element (bytes), must be a power of two
+  * @param  SetBufferSize  : size of buffer (elements), must be a power of two and (SetElementSize*SetBufferSize) a multiple of page size
+  * @retval 0 -> success
+  *         1 -> error, invalid size or mapping failed
+  */
+uint8_t CircularBuffer_InitMirror(circularBuffer_TypeDef *targetBuf, int8_t SetElementSize, int32_t SetBufferSize)
+{
+#if defined(__linux__)
+    size_t  byteSize;
+    long    pageSize;
+    int     fd;
+    uint8_t *base;
+
+    if((SetElementSize <= 0) || (SetBufferSize <= 0))      return 1;
+
+    byteSize = (size_t)SetElementSize*(size_t)SetBufferSize;
+    pageSize = sysconf(_SC_PAGESIZE);
+    if((pageSize <= 0) || (byteSize % (size_t)pageSize != 0))   return 1;
+
+    fd = memfd_create("circularBuffer", MFD_CLOEXEC);
+    if(fd < 0)      return 1;
+    if(ftruncate(fd, (off_t)byteSize) != 0)
+    {
+        close(fd);
+        return 1;
+    }
+
+    /* Reserve 2x address space, then map the memfd pages into both halves */
+    base = (uint8_t *)mmap(NULL, 2*byteSize, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(base == MAP_FAILED)
+    {
+        close(fd);
+        return 1;
+    }
+    if((mmap(base, byteSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED) ||
+       (mmap(base + byteSize, byteSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED))
+    {
+        munmap(base, 2*byteSize);
+        close(fd);
+        return 1;
+    }
+    close(fd);      //mappings keep the pages alive
+
+    if(CircularBuffer_InitPow2(targetBuf, base, SetElementSize, SetBufferSize) != 0)
+    {
+        munmap(base, 2*byteSize);
+        return 1;
+    }
+    targetBuf->mirrored = 1;
+    return 0;
+#else
+    (void)targetBuf;
+    (void)SetElementSize;
+    (void)SetBufferSize;
+    return 1;
+#endif
+}
+
+/**
+  * @brief  CircularBuffer_DeInitMirror() : This function is used to release the storage of a buffer from CircularBuffer_InitMirror().
+  * @param  targetBuf : target circular buffer
+  * @retval None
+  */
+void CircularBuffer_DeInitMirror(circularBuffer_TypeDef *targetBuf)
+{
+#if defined(__linux__)
+    if(targetBuf->mirrored)
+    {
+        munmap(targetBuf->buf, 2*(size_t)targetBuf->elementSize*(size_t)targetBuf->bufferSize);
+        targetBuf->buf = NULL;
+        targetBuf->mirrored = 0;
+    }
+#else
+    (void)targetBuf;
+#endif
+}
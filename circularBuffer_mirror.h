@@ -0,0 +1,28 @@
+/**
+  * circularBuffer_mirror.h - virtual-memory mirrored storage for circular buffer in C (Linux).
+  *
+  * To the extent possible under law, the author(s) have dedicated all
+  * copyright and related and neighboring rights to this software to
+  * the public domain worldwide. This software is distributed without
+  * any warranty.
+  *
+  */
+
+#ifndef  __CIRCULARBUFFER_MIRROR_H
+#define  __CIRCULARBUFFER_MIRROR_H
+
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "circularBuffer.h"
+
+/* Function Prototyping for circularBuffer_mirror.h */
+uint8_t CircularBuffer_InitMirror   (circularBuffer_TypeDef *targetBuf,
+                                     int8_t SetElementSize,
+                                     int32_t SetBufferSize);
+
+void    CircularBuffer_DeInitMirror (circularBuffer_TypeDef *targetBuf);
+
+#endif
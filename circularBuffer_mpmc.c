@@ -0,0 +1,201 @@
+/**
+  * circularBuffer_mpmc.c - lock-free multi-producer/multi-consumer circular buffer (FIFO) in C.
+  *
+  * To the extent possible under law, the author(s) have dedicated all
+  * copyright and related and neighboring rights to this software to
+  * the public domain worldwide. This software is distributed without
+  * any warranty.
+  *
+  * How to use this file:
+    --------------------
+    + First, you need to declare a FIFO buffer structure with "circularBufferMPMC_TypeDef" type in circularBuffer_mpmc.h.
+    + Any number of threads may en-queue and any number of threads may de-queue at the same time (MPSC is a special case).
+    + There're 3 main functions for MPMC circular buffer,
+      1) To En-queue a MPMC circular buffer,    call the function CircularBufferMPMC_Enqueue()
+      2) To De-queue a MPMC circular buffer,    call the function CircularBufferMPMC_Dequeue()
+      3) To initialize a MPMC circular buffer,  call the function CircularBufferMPMC_Init()
+
+    + Each en-queue is done in 3 steps,
+      1) Reserve : a contiguous range [reservedR, reservedR + n) is claimed with a single compare-and-swap.
+      2) Copy    : the data is copied into the claimed range by memcpy(). Producers copy in parallel.
+      3) Commit  : r is moved to the end of the range, in reservation order. A producer waits only
+                   for producers which reserved an earlier range to commit, there is no global lock.
+      De-queue is done the same way with reservedF and f. So, a consumer never sees a partially written block,
+      and a producer never overwrites a block which is still being read.
+**/
+
+#include "circularBuffer_mpmc.h"
+#include "circularBuffer_wait.h"
+
+
+/**
+  * @brief  CircularBufferMPMC_Init() : This function is used to "initialize" a MPMC circular buffer struct.
+  * @param  targetBuf      : target circular buffer
+  * @param  pBuf           : pointer of storage buffer array
+  * @param  SetElementSize : size of each element (bytes)
+  * @param  SetBufferSize  : size of buffer (elements)
+  * @retval None
+  */
+void CircularBufferMPMC_Init(circularBufferMPMC_TypeDef *targetBuf, void *pBuf, int8_t SetElementSize, int32_t SetBufferSize)
+{
+    uint32_t InputByteSize;
+
+    targetBuf->buf = pBuf;
+    targetBuf->bufferSize  = SetBufferSize;
+    targetBuf->elementSize = SetElementSize;
+    atomic_init(&targetBuf->reservedR, 0);
+    atomic_init(&targetBuf->r, 0);
+    atomic_init(&targetBuf->reservedF, 0);
+    atomic_init(&targetBuf->f, 0);
+    InputByteSize = (targetBuf->elementSize)*(targetBuf->bufferSize);
+    memset(targetBuf->buf, 0, InputByteSize);
+}
+
+/**
+  * @brief  CircularBufferMPMC_GetCount() : This function is used to get the number of committed elements in a MPMC circular buffer.
+  *                                         The result is a snapshot, it can be changed by other threads after return.
+  * @param  targetBuf : target circular buffer
+  * @retval number of elements in buffer
+  */
+uint32_t CircularBufferMPMC_GetCount(circularBufferMPMC_TypeDef *targetBuf)
+{
+    uint64_t front = atomic_load_explicit(&targetBuf->f, memory_order_acquire);
+    uint64_t rear  = atomic_load_explicit(&targetBuf->r, memory_order_acquire);
+
+    if(rear < front)    return 0;       //f has been committed after r was loaded
+    return (uint32_t)(rear - front);
+}
+
+/**
+  * @brief  CircularBufferMPMC_IsFull() : This function is used to check if a MPMC circular buffer is full or not.
+  * @param  targetBuf : target circular buffer
+  * @retval 0 -> not full
+  *         1 -> full
+  */
+uint8_t CircularBufferMPMC_IsFull(circularBufferMPMC_TypeDef *targetBuf)
+{
+    if(CircularBufferMPMC_GetCount(targetBuf) >= (uint32_t)targetBuf->bufferSize)     return 1;
+    else        return 0;
+}
+
+/**
+  * @brief  CircularBufferMPMC_IsEmpty() : This function is used to check if a MPMC circular buffer is empty or not.
+  * @param  targetBuf : target circular buffer
+  * @retval 0 -> not empty
+  *         1 -> empty
+  */
+uint8_t CircularBufferMPMC_IsEmpty(circularBufferMPMC_TypeDef *targetBuf)
+{
+    if(CircularBufferMPMC_GetCount(targetBuf) == 0)     return 1;
+    else        return 0;
+}
+
+/**
+  * @brief  CircularBufferMPMC_Enqueue() : This function is used to "En-queue" an input data into a MPMC circular buffer.
+  *                                        Safe to be called from many threads at the same time.
+  *
+  *                                        Warning! : Elements which do not fit into the free space are not en-queued.
+  * @param  targetBuf    : target circular buffer
+  * @param  enqueueData  : enqueued data pointer
+  * @param  enqueueSize  : size of enqueued data (#of element)
+  * @retval number of en-queued elements
+  */
+uint32_t CircularBufferMPMC_Enqueue(circularBufferMPMC_TypeDef *targetBuf, const void *enqueueData, uint32_t enqueueSize)
+{
+    uint64_t start;
+    uint64_t front;
+    uint32_t freeSize;
+    uint32_t n;
+    uint32_t index;
+    uint32_t firstSize;
+    uint32_t spinCount = 0;
+
+    /* 1) Reserve a contiguous range, limited again on each retry (the request is not reduced by a failed attempt) */
+    start = atomic_load_explicit(&targetBuf->reservedR, memory_order_relaxed);
+    do
+    {
+        front    = atomic_load_explicit(&targetBuf->f, memory_order_acquire);
+        freeSize = (uint32_t)targetBuf->bufferSize - (uint32_t)(start - front);
+        n = (enqueueSize > freeSize) ? freeSize : enqueueSize;
+        if(n == 0)                      return 0;
+    }
+    while(!atomic_compare_exchange_weak_explicit(&targetBuf->reservedR, &start, start + n,
+                                                 memory_order_relaxed, memory_order_relaxed));
+
+    /* 2) Copy into the reserved range */
+    index = (uint32_t)(start % (uint64_t)targetBuf->bufferSize);
+    if(index + n <= (uint32_t)targetBuf->bufferSize)
+    {
+        memcpy((void *)((uint8_t *)(targetBuf->buf) + targetBuf->elementSize*index), enqueueData, targetBuf->elementSize*n);
+    }
+    else
+    {
+        firstSize = (uint32_t)targetBuf->bufferSize - index;
+        memcpy((void *)((uint8_t *)(targetBuf->buf) + targetBuf->elementSize*index), enqueueData, targetBuf->elementSize*firstSize);
+        memcpy(targetBuf->buf, (const void *)((const uint8_t *)(enqueueData) + targetBuf->elementSize*firstSize), targetBuf->elementSize*(n - firstSize));
+    }
+
+    /* 3) Commit in order : wait for producers with an earlier range */
+    while(atomic_load_explicit(&targetBuf->r, memory_order_acquire) != start)
+    {
+        CircularBuffer_CpuRelax(&spinCount);
+    }
+    atomic_store_explicit(&targetBuf->r, start + n, memory_order_release);
+
+    return n;
+}
+
+/**
+  * @brief  CircularBufferMPMC_Dequeue() : This function is used to "De-queue" data from a MPMC circular buffer.
+  *                                        Safe to be called from many threads at the same time.
+  *
+  *                                        Warning! : The de-queued region is not cleared, the slots are owned by producers after commit.
+  * @param  targetBuf    : target circular buffer
+  * @param  dequeueData  : dequeued data pointer
+  * @param  dequeueSize  : size of dequeued data (#of element)
+  * @retval number of de-queued elements
+  */
+uint32_t CircularBufferMPMC_Dequeue(circularBufferMPMC_TypeDef *targetBuf, void *dequeueData, uint32_t dequeueSize)
+{
+    uint64_t start;
+    uint64_t rear;
+    uint32_t usedSize;
+    uint32_t n;
+    uint32_t index;
+    uint32_t firstSize;
+    uint32_t spinCount = 0;
+
+    /* 1) Reserve a contiguous range of committed elements, limited again on each retry */
+    start = atomic_load_explicit(&targetBuf->reservedF, memory_order_relaxed);
+    do
+    {
+        rear     = atomic_load_explicit(&targetBuf->r, memory_order_acquire);
+        usedSize = (rear > start) ? (uint32_t)(rear - start) : 0;
+        n = (dequeueSize > usedSize) ? usedSize : dequeueSize;
+        if(n == 0)                      return 0;
+    }
+    while(!atomic_compare_exchange_weak_explicit(&targetBuf->reservedF, &start, start + n,
+                                                 memory_order_relaxed, memory_order_relaxed));
+
+    /* 2) Copy out of the reserved range */
+    index = (uint32_t)(start % (uint64_t)targetBuf->bufferSize);
+    if(index + n <= (uint32_t)targetBuf->bufferSize)
+    {
+        memcpy(dequeueData, (const void *)((uint8_t *)(targetBuf->buf) + targetBuf->elementSize*index), targetBuf->elementSize*n);
+    }
+    else
+    {
+        firstSize = (uint32_t)targetBuf->bufferSize - index;
+        memcpy(dequeueData, (const void *)((uint8_t *)(targetBuf->buf) + targetBuf->elementSize*index), targetBuf->elementSize*firstSize);
+        memcpy((void *)((uint8_t *)(dequeueData) + targetBuf->elementSize*firstSize), targetBuf->buf, targetBuf->elementSize*(n - firstSize));
+    }
+
+    /* 3) Commit in order : wait for consumers with an earlier range */
+    while(atomic_load_explicit(&targetBuf->f, memory_order_acquire) != start)
+    {
+        CircularBuffer_CpuRelax(&spinCount);
+    }
+    atomic_store_explicit(&targetBuf->f, start + n, memory_order_release);
+
+    return n;
+}
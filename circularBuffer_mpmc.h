@@ -0,0 +1,62 @@
+/**
+  * circularBuffer_mpmc.h - lock-free multi-producer/multi-consumer circular buffer (FIFO) in C.
+  *
+  * To the extent possible under law, the author(s) have dedicated all
+  * copyright and related and neighboring rights to this software to
+  * the public domain worldwide. This software is distributed without
+  * any warranty.
+  *
+  */
+
+#ifndef  __CIRCULARBUFFER_MPMC_H
+#define  __CIRCULARBUFFER_MPMC_H
+
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdatomic.h>
+
+#include "circularBuffer.h"
+
+typedef struct {
+
+    /* Producer cache lines */
+    _Alignas(CIRCULAR_BUFFER_CACHE_LINE_SIZE)
+    _Atomic uint64_t    reservedR;      //rear reserved by producers  (claimed, maybe not written yet)
+    _Alignas(CIRCULAR_BUFFER_CACHE_LINE_SIZE)
+    _Atomic uint64_t    r;              //rear committed by producers (visible to consumers)
+
+    /* Consumer cache lines */
+    _Alignas(CIRCULAR_BUFFER_CACHE_LINE_SIZE)
+    _Atomic uint64_t    reservedF;      //front reserved by consumers  (claimed, maybe not read yet)
+    _Alignas(CIRCULAR_BUFFER_CACHE_LINE_SIZE)
+    _Atomic uint64_t    f;              //front committed by consumers (free for producers)
+
+    /* Read-only after CircularBufferMPMC_Init() */
+    _Alignas(CIRCULAR_BUFFER_CACHE_LINE_SIZE)
+    void                *buf;           //pointer of 1-D data array
+    int32_t             bufferSize;     //buffer size (elements)
+    int8_t              elementSize;    //size per element (bytes)
+
+} circularBufferMPMC_TypeDef;
+
+/* Function Prototyping for circularBuffer_mpmc.h */
+uint32_t CircularBufferMPMC_Enqueue (circularBufferMPMC_TypeDef *targetBuf,
+                                     const void *enqueueData,
+                                     uint32_t enqueueSize);
+
+uint32_t CircularBufferMPMC_Dequeue (circularBufferMPMC_TypeDef *targetBuf,
+                                     void *dequeueData,
+                                     uint32_t dequeueSize);
+
+void     CircularBufferMPMC_Init    (circularBufferMPMC_TypeDef *targetBuf,
+                                     void *pBuf,
+                                     int8_t SetElementSize,
+                                     int32_t SetBufferSize);
+
+uint32_t CircularBufferMPMC_GetCount (circularBufferMPMC_TypeDef *targetBuf);
+uint8_t  CircularBufferMPMC_IsEmpty  (circularBufferMPMC_TypeDef *targetBuf);
+uint8_t  CircularBufferMPMC_IsFull   (circularBufferMPMC_TypeDef *targetBuf);
+
+#endif
@@ -0,0 +1,186 @@
+/**
+  * circularBuffer_persist.c - file-backed persistent storage for circular buffer in C (Linux/POSIX).
+  *
+  * To the extent possible under law, the author(s) have dedicated all
+  * copyright and related and neighboring rights to this software to
+  * the public domain worldwide. This software is distributed without
+  * any warranty.
+  *
+  * How to use this file:
+    --------------------
+    + CircularBuffer_OpenPersistent() maps a local file as the storage of a circular buffer (BUF_MODE_POW2). A new file is created
+      and sized, an existing file is reopened with its data and its rPos,fPos indices as stored by the last sync.
+    + En-queue and de-queue work in the mapping like on any buffer. Each change of rPos,fPos is also stored into the file header
+      (fPos before an overwrite, rPos after the data is written), so the page cache always holds matching data and indices,
+      and a crash of the process at any point is recovered by a reopen, without any sync. CircularBuffer_SyncPersistent() is
+      the durability barrier against a crash of the system :
+          BUF_PERSIST_PROCESS -> nothing more to do, data and indices are in the page cache and survive a crash of the process
+          BUF_PERSIST_DISK    -> msync(), data and indices survive a crash of the system (slow, call it rarely)
+      After a crash of the system, pages written back after the last BUF_PERSIST_DISK sync may mix newer data with older indices.
+    + The scrub policy is set to BUF_SCRUB_NONE, so de-queued elements stay in the file as history. After a restart,
+      CircularBuffer_ReplayPersistent() queues the retained window again (the last bufferSize en-queued elements),
+      then DSP_frameExtraction_IsNextFrameReady() replays it from memory at full speed.
+    + Release the mapping with CircularBuffer_ClosePersistent(), which also syncs with BUF_PERSIST_PROCESS.
+**/
+
+#if defined(__linux__)
+#define _GNU_SOURCE
+#elif defined(__unix__) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#if defined(__unix__)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "circularBuffer_persist.h"
+
+
+/**
+  * @brief  CircularBuffer_OpenPersistent() : This function is used to "initialize" a FIFO circular buffer struct with a file as storage.
+  * @param  targetBuf      : target circular buffer
+  * @param  persist        : mapping struct of the file
+  * @param  path           : file path (created if it does not exist)
+  * @param  SetElementSize : size of each element (bytes), must be a power of two
+  * @param  SetBufferSize  : size of buffer (elements), must be a power of two
+  * @retval 0 -> success
+  *         1 -> error, invalid size, file of another buffer size or mapping failed
+  */
+uint8_t CircularBuffer_OpenPersistent(circularBuffer_TypeDef *targetBuf, circularBufferPersist_TypeDef *persist, const char *path,
+                                      int8_t SetElementSize, int32_t SetBufferSize)
+{
+#if defined(__unix__)
+    circularBufferPersistHeader_TypeDef *header;
+    struct stat                         st;
+    size_t                              mapSize;
+    uint8_t                             newFile;
+    int                                 fd;
+
+    if(CircularBuffer_InitPow2(targetBuf, NULL, SetElementSize, SetBufferSize) != 0)     return 1;
+    mapSize = CIRCULAR_BUFFER_PERSIST_DATA_OFFSET + (size_t)SetElementSize*(size_t)SetBufferSize;
+
+    fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if(fd < 0)      return 1;
+    if(fstat(fd, &st) != 0)
+    {
+        close(fd);
+        return 1;
+    }
+
+    newFile = (st.st_size == 0);
+    if((newFile && (ftruncate(fd, (off_t)mapSize) != 0)) || (!newFile && ((size_t)st.st_size != mapSize)))
+    {
+        close(fd);
+        return 1;
+    }
+
+    header = (circularBufferPersistHeader_TypeDef *)mmap(NULL, mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if(header == MAP_FAILED)
+    {
+        close(fd);
+        return 1;
+    }
+
+    if(newFile)
+    {
+        /* New file is zero-filled : empty buffer */
+        header->version     = CIRCULAR_BUFFER_PERSIST_VERSION;
+        header->bufferSize  = SetBufferSize;
+        header->elementSize = SetElementSize;
+        header->rPos        = 0;
+        header->fPos        = 0;
+        header->magic       = CIRCULAR_BUFFER_PERSIST_MAGIC;
+    }
+    else if((header->magic != CIRCULAR_BUFFER_PERSIST_MAGIC) || (header->version != CIRCULAR_BUFFER_PERSIST_VERSION) ||
+            (header->bufferSize != SetBufferSize) || (header->elementSize != SetElementSize))
+    {
+        munmap(header, mapSize);
+        close(fd);
+        return 1;
+    }
+
+    /* A crash inside CircularBuffer_SyncPersistent() can leave one new and one old index, keep the pair valid */
+    if(header->fPos > header->rPos)                                 header->fPos = header->rPos;
+    if(header->rPos - header->fPos > (uint64_t)SetBufferSize)       header->fPos = header->rPos - (uint64_t)SetBufferSize;
+
+    targetBuf->buf  = (uint8_t *)header + CIRCULAR_BUFFER_PERSIST_DATA_OFFSET;
+    targetBuf->rPos = header->rPos;
+    targetBuf->fPos = header->fPos;
+    targetBuf->scrubPolicy = BUF_SCRUB_NONE;
+    targetBuf->persistent = 1;
+    targetBuf->persistHeader = header;
+
+    persist->header  = header;
+    persist->mapSize = mapSize;
+    persist->fd      = fd;
+    return 0;
+#else
+    (void)targetBuf;
+    (void)persist;
+    (void)path;
+    (void)SetElementSize;
+    (void)SetBufferSize;
+    return 1;
+#endif
+}
+
+/**
+  * @brief  CircularBuffer_SyncPersistent() : This function is used to make the data and indices of a persistent circular buffer durable.
+  *                                           Indices are already stored by each en-queue/de-queue, they are stored again here.
+  * @param  targetBuf  : target circular buffer
+  * @param  persist    : mapping struct from CircularBuffer_OpenPersistent()
+  * @param  durability : BUF_PERSIST_PROCESS or BUF_PERSIST_DISK
+  * @retval 0 -> success
+  *         1 -> error, msync() failed
+  */
+uint8_t CircularBuffer_SyncPersistent(circularBuffer_TypeDef *targetBuf, circularBufferPersist_TypeDef *persist, uint8_t durability)
+{
+    persist->header->fPos = targetBuf->fPos;
+    persist->header->rPos = targetBuf->rPos;
+
+#if defined(__unix__)
+    if((durability == BUF_PERSIST_DISK) && (msync(persist->header, persist->mapSize, MS_SYNC) != 0))     return 1;
+#else
+    (void)durability;
+#endif
+    return 0;
+}
+
+/**
+  * @brief  CircularBuffer_ReplayPersistent() : This function is used to queue the retained window of a persistent circular buffer again.
+  *                                            Elements which are still queued are kept, older de-queued elements in buffer are added in front.
+  * @param  targetBuf : target circular buffer from CircularBuffer_OpenPersistent()
+  * @retval number of elements in buffer (retained window)
+  */
+uint32_t CircularBuffer_ReplayPersistent(circularBuffer_TypeDef *targetBuf)
+{
+    if(targetBuf->rPos > (uint64_t)targetBuf->bufferSize)   targetBuf->fPos = targetBuf->rPos - (uint64_t)targetBuf->bufferSize;
+    else                                                    targetBuf->fPos = 0;
+    if(targetBuf->persistHeader != NULL)                    targetBuf->persistHeader->fPos = targetBuf->fPos;
+    return (uint32_t)(targetBuf->rPos - targetBuf->fPos);
+}
+
+/**
+  * @brief  CircularBuffer_ClosePersistent() : This function is used to sync and release the file of a persistent circular buffer.
+  * @param  targetBuf : target circular buffer
+  * @param  persist   : mapping struct from CircularBuffer_OpenPersistent()
+  * @retval None
+  */
+void CircularBuffer_ClosePersistent(circularBuffer_TypeDef *targetBuf, circularBufferPersist_TypeDef *persist)
+{
+    if(persist->header == NULL)     return;
+
+    CircularBuffer_SyncPersistent(targetBuf, persist, BUF_PERSIST_PROCESS);
+#if defined(__unix__)
+    munmap(persist->header, persist->mapSize);
+    close(persist->fd);
+#endif
+    persist->header = NULL;
+    persist->fd = -1;
+    targetBuf->buf = NULL;
+    targetBuf->persistent = 0;
+    targetBuf->persistHeader = NULL;
+}
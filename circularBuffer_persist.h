@@ -0,0 +1,67 @@
+/**
+  * circularBuffer_persist.h - file-backed persistent storage for circular buffer in C (Linux/POSIX).
+  *
+  * To the extent possible under law, the author(s) have dedicated all
+  * copyright and related and neighboring rights to this software to
+  * the public domain worldwide. This software is distributed without
+  * any warranty.
+  *
+  */
+
+#ifndef  __CIRCULARBUFFER_PERSIST_H
+#define  __CIRCULARBUFFER_PERSIST_H
+
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "circularBuffer.h"
+
+/* Identification of a buffer file, checked by CircularBuffer_OpenPersistent() */
+#define     CIRCULAR_BUFFER_PERSIST_MAGIC       0x43425046u     //"CBPF"
+#define     CIRCULAR_BUFFER_PERSIST_VERSION     1
+#define     CIRCULAR_BUFFER_PERSIST_DATA_OFFSET 4096            //data array starts on its own page
+
+/* Define of durability levels of CircularBuffer_SyncPersistent() */
+#define     BUF_PERSIST_PROCESS             0       //indices are already in the mapping, survives a crash of the process
+#define     BUF_PERSIST_DISK                1       //mapping is also written to disk (msync), survives a crash of the system
+
+/* Header at offset 0 of the file */
+typedef struct circularBufferPersistHeader {
+
+    uint32_t            magic;          //CIRCULAR_BUFFER_PERSIST_MAGIC
+    uint32_t            version;        //CIRCULAR_BUFFER_PERSIST_VERSION
+    int32_t             bufferSize;     //buffer size (elements)
+    int8_t              elementSize;    //size per element (bytes)
+    uint64_t            rPos;           //total enqueued elements, stored by each en-queue
+    uint64_t            fPos;           //total dequeued elements, stored by each de-queue (and overwrite)
+
+} circularBufferPersistHeader_TypeDef;
+
+/* Mapping of a buffer file */
+typedef struct {
+
+    circularBufferPersistHeader_TypeDef *header;    //mapping of the file
+    size_t              mapSize;        //size of mapping (bytes)
+    int32_t             fd;             //file descriptor
+
+} circularBufferPersist_TypeDef;
+
+/* Function Prototyping for circularBuffer_persist.h */
+uint8_t CircularBuffer_OpenPersistent   (circularBuffer_TypeDef *targetBuf,
+                                         circularBufferPersist_TypeDef *persist,
+                                         const char *path,
+                                         int8_t SetElementSize,
+                                         int32_t SetBufferSize);
+
+uint8_t CircularBuffer_SyncPersistent   (circularBuffer_TypeDef *targetBuf,
+                                         circularBufferPersist_TypeDef *persist,
+                                         uint8_t durability);
+
+uint32_t CircularBuffer_ReplayPersistent(circularBuffer_TypeDef *targetBuf);
+
+void    CircularBuffer_ClosePersistent  (circularBuffer_TypeDef *targetBuf,
+                                         circularBufferPersist_TypeDef *persist);
+
+#endif
@@ -0,0 +1,236 @@
+/**
+  * circularBuffer_record.c - variable-length record mode for circular buffer in C.
+  *
+  * To the extent possible under law, the author(s) have dedicated all
+  * copyright and related and neighboring rights to this software to
+  * the public domain worldwide. This software is distributed without
+  * any warranty.
+  *
+  * How to use this file:
+    --------------------
+    + CircularBuffer_InitRecord() initializes a circular buffer of bytes (elementSize = 1) which holds records of any size.
+      Each record is an 8-byte header (payload size) followed by the payload, padded to CIRCULAR_BUFFER_RECORD_ALIGN :
+
+          | hdr | payload ..pad | hdr | payload .. | SKIP ......... |   (wrap point)
+
+      A record is never split at the wrap point. When it does not fit before the end of buffer, a skip marker fills the rest
+      and the record starts at the beginning, so the payload is always contiguous.
+    + Producer : CircularBuffer_EnqueueRecord() copies a record, or CircularBuffer_ReserveRecord() gives the payload address
+      to write in place, then CircularBuffer_CommitRecord() en-queues it (zero-copy).
+    + Consumer : CircularBuffer_PeekRecord() gives the payload address of the oldest record to read in place,
+      then CircularBuffer_ConsumeRecord() de-queues it (zero-copy), or CircularBuffer_DequeueRecord() copies it out.
+    + Sizes, GetCount(), watermarks and events of the underlying buffer are in bytes, including headers and padding.
+    + Like circularBuffer_TypeDef, a record buffer is not thread-safe.
+**/
+
+#include "circularBuffer_record.h"
+
+#define CIRCULAR_BUFFER_RECORD_HEADER   ((uint32_t)sizeof(circularBufferRecordHeader_TypeDef))
+
+
+/**
+  * @brief  CircularBuffer_RecordBytes() : Size of a record in buffer (header + payload + padding), 0 -> empty or too large.
+  */
+static inline uint32_t CircularBuffer_RecordBytes(uint32_t recordSize)
+{
+    if((recordSize == 0) || (recordSize > UINT32_MAX - 2*CIRCULAR_BUFFER_RECORD_ALIGN))      return 0;
+    return CIRCULAR_BUFFER_RECORD_HEADER + ((recordSize + CIRCULAR_BUFFER_RECORD_ALIGN - 1) & ~(uint32_t)(CIRCULAR_BUFFER_RECORD_ALIGN - 1));
+}
+
+/**
+  * @brief  CircularBuffer_FindRecordSpace() : Find contiguous free space for recordBytes at rear, called by CircularBuffer_ReserveRecord().
+  * @param  targetBuf   : target circular buffer
+  * @param  recordBytes : size of record in buffer
+  * @param  skip        : output, region to fill with a skip marker before the record (size 0 -> no skip)
+  * @retval address of record header, NULL -> no space
+  */
+static uint8_t *CircularBuffer_FindRecordSpace(circularBuffer_TypeDef *targetBuf, uint32_t recordBytes, circularBufferSpan_TypeDef *skip)
+{
+    circularBufferSpan_TypeDef span[2];
+
+    /* span[0] is free space from rear to end of buffer, span[1] is free space from start of buffer */
+    CircularBuffer_Reserve(targetBuf, span, (uint32_t)targetBuf->bufferSize);
+
+    skip->data = span[0].data;
+    skip->size = 0;
+    if(recordBytes == 0)                return NULL;
+    if(span[0].size >= recordBytes)     return (uint8_t *)span[0].data;
+    if(span[1].size >= recordBytes)
+    {
+        skip->size = span[0].size;
+        return (uint8_t *)span[1].data;
+    }
+    return NULL;
+}
+
+/**
+  * @brief  CircularBuffer_InitRecord() : This function is used to "initialize" a circular buffer struct in record mode.
+  * @param  targetBuf     : target circular buffer
+  * @param  pBuf          : pointer of storage buffer array, aligned to CIRCULAR_BUFFER_RECORD_ALIGN
+  * @param  SetBufferSize : size of buffer (bytes), multiple of CIRCULAR_BUFFER_RECORD_ALIGN
+  * @retval 0 -> success
+  *         1 -> error, size or alignment
+  */
+uint8_t CircularBuffer_InitRecord(circularBuffer_TypeDef *targetBuf, void *pBuf, int32_t SetBufferSize)
+{
+    if((SetBufferSize <= 0) || (SetBufferSize % CIRCULAR_BUFFER_RECORD_ALIGN != 0))     return 1;
+    if(((uintptr_t)pBuf % CIRCULAR_BUFFER_RECORD_ALIGN) != 0)                           return 1;
+
+    if(CircularBuffer_InitPow2(targetBuf, pBuf, 1, SetBufferSize) != 0)
+    {
+        CircularBuffer_Init(targetBuf, pBuf, 1, SetBufferSize);
+    }
+    return 0;
+}
+
+/**
+  * @brief  CircularBuffer_ReserveRecord() : This function is used to get the payload address of the next record, without copying.
+  *                                         Producer writes the payload in place, then calls CircularBuffer_CommitRecord().
+  *                                         The placement (and skip marker) is written into the free space at rear,
+  *                                         so the commit uses the reserved address even if the committed record is smaller.
+  *
+  *                                         Warning! : On a buffer which is not a power of two, do not de-queue the last record
+  *                                                    between reserve and commit (an empty buffer restarts at index 0).
+  * @param  targetBuf    : target circular buffer in record mode
+  * @param  recordSize   : maximum payload size (bytes), at least 1
+  * @retval payload address (contiguous, aligned), NULL -> not enough space
+  */
+void *CircularBuffer_ReserveRecord(circularBuffer_TypeDef *targetBuf, uint32_t recordSize)
+{
+    circularBufferRecordHeader_TypeDef  *header;
+    uint32_t                            recordBytes = CircularBuffer_RecordBytes(recordSize);
+    circularBufferSpan_TypeDef          skip;
+    uint8_t                             *record = CircularBuffer_FindRecordSpace(targetBuf, recordBytes, &skip);
+
+    if(record == NULL)      return NULL;
+
+    /* Header at rear : a skip marker if the record starts at the beginning of buffer */
+    header = (circularBufferRecordHeader_TypeDef *)skip.data;
+    header->size = (skip.size > 0) ? CIRCULAR_BUFFER_RECORD_SKIP : CIRCULAR_BUFFER_RECORD_PENDING;
+    header->reserved = recordBytes;
+
+    header = (circularBufferRecordHeader_TypeDef *)record;
+    header->size = CIRCULAR_BUFFER_RECORD_PENDING;
+    header->reserved = recordBytes;
+    return record + CIRCULAR_BUFFER_RECORD_HEADER;
+}
+
+/**
+  * @brief  CircularBuffer_CommitRecord() : This function is used to "En-queue" a record written in place after CircularBuffer_ReserveRecord().
+  * @param  targetBuf    : target circular buffer in record mode
+  * @param  recordSize   : payload size (bytes), at least 1 and not larger than the reserved size
+  * @retval recordSize -> en-queued
+  *         0          -> no reservation, or recordSize is larger than the reserved size, nothing is en-queued
+  */
+uint32_t CircularBuffer_CommitRecord(circularBuffer_TypeDef *targetBuf, uint32_t recordSize)
+{
+    circularBufferRecordHeader_TypeDef  *header;
+    circularBufferSpan_TypeDef          span[2];
+    uint32_t                            recordBytes = CircularBuffer_RecordBytes(recordSize);
+    uint32_t                            skipSize = 0;
+
+    /* span[0] starts with the header written by CircularBuffer_ReserveRecord() */
+    if(CircularBuffer_Reserve(targetBuf, span, (uint32_t)targetBuf->bufferSize) == 0)      return 0;
+
+    header = (circularBufferRecordHeader_TypeDef *)span[0].data;
+    if(header->size == CIRCULAR_BUFFER_RECORD_SKIP)
+    {
+        skipSize = span[0].size;
+        header = (circularBufferRecordHeader_TypeDef *)span[1].data;
+        if(span[1].size < CIRCULAR_BUFFER_RECORD_HEADER)        return 0;
+    }
+    if((header->size != CIRCULAR_BUFFER_RECORD_PENDING) || (recordBytes == 0) || (recordBytes > header->reserved))     return 0;
+
+    if(skipSize > 0)
+    {
+        /* Pad up to the wrap point, the record starts at the beginning of buffer */
+        ((circularBufferRecordHeader_TypeDef *)span[0].data)->reserved = 0;
+        CircularBuffer_Commit(targetBuf, skipSize);
+    }
+
+    header->size = recordSize;
+    header->reserved = 0;
+    CircularBuffer_Commit(targetBuf, recordBytes);
+    return recordSize;
+}
+
+/**
+  * @brief  CircularBuffer_EnqueueRecord() : This function is used to "En-queue" a whole record into a circular buffer in record mode.
+  * @param  targetBuf    : target circular buffer in record mode
+  * @param  enqueueData  : payload pointer
+  * @param  recordSize   : payload size (bytes), at least 1
+  * @retval recordSize -> en-queued
+  *         0          -> not enough space, nothing is en-queued
+  */
+uint32_t CircularBuffer_EnqueueRecord(circularBuffer_TypeDef *targetBuf, const void *enqueueData, uint32_t recordSize)
+{
+    void *payload = CircularBuffer_ReserveRecord(targetBuf, recordSize);
+
+    if(payload == NULL)     return 0;
+    memcpy(payload, enqueueData, recordSize);
+    return CircularBuffer_CommitRecord(targetBuf, recordSize);
+}
+
+/**
+  * @brief  CircularBuffer_PeekRecord() : This function is used to get the oldest record of a circular buffer in record mode, without copying.
+  *                                      Skip markers in front are de-queued. Payload is valid until CircularBuffer_ConsumeRecord().
+  * @param  targetBuf    : target circular buffer in record mode
+  * @param  recordSize   : output, payload size (bytes)
+  * @retval payload address (contiguous, aligned), NULL -> buffer is empty
+  */
+const void *CircularBuffer_PeekRecord(circularBuffer_TypeDef *targetBuf, uint32_t *recordSize)
+{
+    circularBufferSpan_TypeDef          span[2];
+    circularBufferRecordHeader_TypeDef  *header;
+
+    while(CircularBuffer_Peek(targetBuf, span, CIRCULAR_BUFFER_RECORD_HEADER) == CIRCULAR_BUFFER_RECORD_HEADER)
+    {
+        header = (circularBufferRecordHeader_TypeDef *)span[0].data;
+        if(header->size != CIRCULAR_BUFFER_RECORD_SKIP)
+        {
+            *recordSize = header->size;
+            return (const uint8_t *)header + CIRCULAR_BUFFER_RECORD_HEADER;
+        }
+
+        /* Skip marker : padding up to the wrap point */
+        CircularBuffer_Peek(targetBuf, span, (uint32_t)targetBuf->bufferSize);
+        CircularBuffer_Consume(targetBuf, span[0].size);
+    }
+    *recordSize = 0;
+    return NULL;
+}
+
+/**
+  * @brief  CircularBuffer_ConsumeRecord() : This function is used to "De-queue" the oldest record of a circular buffer in record mode, without copying.
+  * @param  targetBuf    : target circular buffer in record mode
+  * @retval None
+  */
+void CircularBuffer_ConsumeRecord(circularBuffer_TypeDef *targetBuf)
+{
+    uint32_t recordSize;
+
+    if(CircularBuffer_PeekRecord(targetBuf, &recordSize) != NULL)
+    {
+        CircularBuffer_Consume(targetBuf, CircularBuffer_RecordBytes(recordSize));
+    }
+}
+
+/**
+  * @brief  CircularBuffer_DequeueRecord() : This function is used to "De-queue" the oldest record of a circular buffer in record mode.
+  * @param  targetBuf    : target circular buffer in record mode
+  * @param  dequeueData  : output payload pointer
+  * @param  dequeueSize  : size of output array (bytes)
+  * @retval payload size of the oldest record, 0 -> buffer is empty
+  *         When it is larger than dequeueSize, nothing is copied and the record stays in buffer.
+  */
+uint32_t CircularBuffer_DequeueRecord(circularBuffer_TypeDef *targetBuf, void *dequeueData, uint32_t dequeueSize)
+{
+    uint32_t    recordSize;
+    const void  *payload = CircularBuffer_PeekRecord(targetBuf, &recordSize);
+
+    if((payload == NULL) || (recordSize > dequeueSize))     return recordSize;
+
+    memcpy(dequeueData, payload, recordSize);
+    CircularBuffer_Consume(targetBuf, CircularBuffer_RecordBytes(recordSize));
+    return recordSize;
+}
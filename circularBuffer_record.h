@@ -0,0 +1,62 @@
+/**
+  * circularBuffer_record.h - variable-length record mode for circular buffer in C.
+  *
+  * To the extent possible under law, the author(s) have dedicated all
+  * copyright and related and neighboring rights to this software to
+  * the public domain worldwide. This software is distributed without
+  * any warranty.
+  *
+  */
+
+#ifndef  __CIRCULARBUFFER_RECORD_H
+#define  __CIRCULARBUFFER_RECORD_H
+
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "circularBuffer.h"
+
+/* Alignment of records in buffer (bytes), also size of record header */
+#define     CIRCULAR_BUFFER_RECORD_ALIGN    8
+
+/* Record size of a skip marker : rest of buffer up to the wrap point is padding */
+#define     CIRCULAR_BUFFER_RECORD_SKIP     0xFFFFFFFFu
+
+/* Record size of a reserved record which is not committed yet */
+#define     CIRCULAR_BUFFER_RECORD_PENDING  0u
+
+/* Header in front of each record */
+typedef struct {
+
+    uint32_t            size;           //payload size (bytes), or CIRCULAR_BUFFER_RECORD_SKIP
+    uint32_t            reserved;       //reserved record size (bytes) until commit, then 0, keeps payload aligned to CIRCULAR_BUFFER_RECORD_ALIGN
+
+} circularBufferRecordHeader_TypeDef;
+
+/* Function Prototyping for circularBuffer_record.h */
+uint8_t     CircularBuffer_InitRecord   (circularBuffer_TypeDef *targetBuf,
+                                         void *pBuf,
+                                         int32_t SetBufferSize);
+
+void       *CircularBuffer_ReserveRecord(circularBuffer_TypeDef *targetBuf,
+                                         uint32_t recordSize);
+
+uint32_t    CircularBuffer_CommitRecord (circularBuffer_TypeDef *targetBuf,
+                                         uint32_t recordSize);
+
+uint32_t    CircularBuffer_EnqueueRecord(circularBuffer_TypeDef *targetBuf,
+                                         const void *enqueueData,
+                                         uint32_t recordSize);
+
+const void *CircularBuffer_PeekRecord   (circularBuffer_TypeDef *targetBuf,
+                                         uint32_t *recordSize);
+
+void        CircularBuffer_ConsumeRecord(circularBuffer_TypeDef *targetBuf);
+
+uint32_t    CircularBuffer_DequeueRecord(circularBuffer_TypeDef *targetBuf,
+                                         void *dequeueData,
+                                         uint32_t dequeueSize);
+
+#endif
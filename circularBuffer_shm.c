@@ -0,0 +1,353 @@
+/**
+  * circularBuffer_shm.c - shared-memory single-producer/single-consumer circular buffer (FIFO) between processes in C (Linux/POSIX).
+  *
+  * To the extent possible under law, the author(s) have dedicated all
+  * copyright and related and neighboring rights to this software to
+  * the public domain worldwide. This software is distributed without
+  * any warranty.
+  *
+  * How to use this file:
+    --------------------
+    + The producer process creates the segment with CircularBufferShm_Create() :
+          name = "/myStream" -> POSIX shared memory (shm_open), the consumer process attaches by name with CircularBufferShm_Attach()
+          name = NULL        -> anonymous memfd, the consumer process gets targetBuf->fd by fork() or a unix socket (SCM_RIGHTS)
+                                and attaches with CircularBufferShm_AttachFd()
+    + The segment holds the header (indices, sizes) and the data array. The header stores the offset of the data array instead of
+      a pointer, so each process can map the segment at a different address.
+    + The protocol is the one of circularBufferSPSC_TypeDef, with the same index and span helpers (circularBuffer_spsc.h) :
+      r and f are free-running counters, published with release and read with acquire, each process keeps a cached copy of
+      the other index in its own handle. After attaching, en-queue, de-queue, CircularBufferShm_Peek() and CircularBufferShm_Consume()
+      never enter the kernel, a frame can be read in place from the consumer mapping.
+    + The header can be written by the other process, so it is not trusted after attaching : the sizes and the data offset are
+      checked once and copied into the handle, only r,f are read from the header. An index of the other process which is more
+      than bufferSize away (crashed or misbehaving peer) gives 0 free space or 0 elements, never an access outside the data array.
+    + Exactly one process (thread) may en-queue and exactly one may de-queue. There is no blocking wait, the consumer polls
+      (or is woken by its own channel, e.g. an eventfd passed with the segment).
+    + Each process calls CircularBufferShm_Detach() when done, the creator of a named segment also calls CircularBufferShm_Unlink().
+    + Link with -lrt on glibc older than 2.34 (shm_open).
+**/
+
+#if defined(__linux__)
+#define _GNU_SOURCE
+#elif defined(__unix__) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#if defined(__unix__)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#define CIRCULAR_BUFFER_SHM_POSIX
+#endif
+
+#include "circularBuffer_shm.h"
+
+
+/**
+  * @brief  CircularBufferShm_Map() : Map a segment and check its header, called by the attach functions.
+  * @retval 0 -> success
+  *         1 -> error
+  */
+static uint8_t CircularBufferShm_Map(circularBufferShm_TypeDef *targetBuf, int32_t fd)
+{
+#if defined(CIRCULAR_BUFFER_SHM_POSIX)
+    struct stat                     st;
+    circularBufferShmHeader_TypeDef *header;
+    uint64_t                        dataOffset;
+    int32_t                         bufferSize;
+    int8_t                          elementSize;
+
+    if((fstat(fd, &st) != 0) || ((size_t)st.st_size < sizeof(circularBufferShmHeader_TypeDef)))     return 1;
+
+    header = (circularBufferShmHeader_TypeDef *)mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if(header == MAP_FAILED)        return 1;
+
+    /* magic is stored last by the creator (release), the other header fields are valid after it.
+       Each field is read once, the checked values are the ones kept in the handle */
+    if(atomic_load_explicit(&header->magic, memory_order_acquire) != CIRCULAR_BUFFER_SHM_MAGIC)
+    {
+        munmap(header, (size_t)st.st_size);
+        return 1;
+    }
+    dataOffset  = header->dataOffset;
+    bufferSize  = header->bufferSize;
+    elementSize = header->elementSize;
+    if((header->version != CIRCULAR_BUFFER_SHM_VERSION) || (elementSize <= 0) || (bufferSize <= 0) ||
+       (dataOffset < sizeof(circularBufferShmHeader_TypeDef)) || (dataOffset > (uint64_t)st.st_size) ||
+       ((uint64_t)elementSize*(uint64_t)bufferSize > (uint64_t)st.st_size - dataOffset))
+    {
+        munmap(header, (size_t)st.st_size);
+        return 1;
+    }
+
+    targetBuf->header      = header;
+    targetBuf->mapSize     = (size_t)st.st_size;
+    targetBuf->fd          = fd;
+    targetBuf->data        = (uint8_t *)header + dataOffset;
+    targetBuf->bufferSize  = (uint32_t)bufferSize;
+    targetBuf->elementSize = elementSize;
+    targetBuf->cachedR = atomic_load_explicit(&header->r, memory_order_acquire);
+    targetBuf->cachedF = atomic_load_explicit(&header->f, memory_order_acquire);
+    return 0;
+#else
+    (void)targetBuf;
+    (void)fd;
+    return 1;
+#endif
+}
+
+/**
+  * @brief  CircularBufferShm_Create() : This function is used to create and "initialize" a shared-memory circular buffer segment.
+  * @param  targetBuf      : handle of this process
+  * @param  name           : POSIX shared memory name ("/name"), or NULL for an anonymous memfd (Linux)
+  * @param  SetElementSize : size of each element (bytes)
+  * @param  SetBufferSize  : size of buffer (elements)
+  * @retval 0 -> success
+  *         1 -> error, invalid size, name already exists or mapping failed
+  */
+uint8_t CircularBufferShm_Create(circularBufferShm_TypeDef *targetBuf, const char *name, int8_t SetElementSize, int32_t SetBufferSize)
+{
+#if defined(CIRCULAR_BUFFER_SHM_POSIX)
+    circularBufferShmHeader_TypeDef *header;
+    uint64_t                        dataOffset;
+    size_t                          mapSize;
+    int                             fd;
+
+    if((SetElementSize <= 0) || (SetBufferSize <= 0))      return 1;
+
+    /* Data array starts on the next cache line after header */
+    dataOffset = (sizeof(circularBufferShmHeader_TypeDef) + CIRCULAR_BUFFER_CACHE_LINE_SIZE - 1) & ~(uint64_t)(CIRCULAR_BUFFER_CACHE_LINE_SIZE - 1);
+    mapSize    = (size_t)dataOffset + (size_t)SetElementSize*(size_t)SetBufferSize;
+
+    if(name != NULL)    fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+    else
+    {
+#if defined(__linux__)
+        fd = memfd_create("circularBufferShm", MFD_CLOEXEC);
+#else
+        fd = -1;
+#endif
+    }
+    if(fd < 0)      return 1;
+
+    if(ftruncate(fd, (off_t)mapSize) != 0)
+    {
+        close(fd);
+        if(name != NULL)    shm_unlink(name);
+        return 1;
+    }
+    header = (circularBufferShmHeader_TypeDef *)mmap(NULL, mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if(header == MAP_FAILED)
+    {
+        close(fd);
+        if(name != NULL)    shm_unlink(name);
+        return 1;
+    }
+
+    /* New segment is zero-filled, so the data array needs no memset() */
+    atomic_init(&header->r, 0);
+    atomic_init(&header->f, 0);
+    header->version     = CIRCULAR_BUFFER_SHM_VERSION;
+    header->dataOffset  = dataOffset;
+    header->bufferSize  = SetBufferSize;
+    header->elementSize = SetElementSize;
+    atomic_store_explicit(&header->magic, CIRCULAR_BUFFER_SHM_MAGIC, memory_order_release);
+
+    targetBuf->header      = header;
+    targetBuf->mapSize     = mapSize;
+    targetBuf->fd          = fd;
+    targetBuf->data        = (uint8_t *)header + dataOffset;
+    targetBuf->bufferSize  = (uint32_t)SetBufferSize;
+    targetBuf->elementSize = SetElementSize;
+    targetBuf->cachedR = 0;
+    targetBuf->cachedF = 0;
+    return 0;
+#else
+    (void)targetBuf;
+    (void)name;
+    (void)SetElementSize;
+    (void)SetBufferSize;
+    return 1;
+#endif
+}
+
+/**
+  * @brief  CircularBufferShm_Attach() : This function is used to attach a named shared-memory circular buffer from another process.
+  * @param  targetBuf : handle of this process
+  * @param  name      : POSIX shared memory name given to CircularBufferShm_Create()
+  * @retval 0 -> success
+  *         1 -> error, segment does not exist or is not a circular buffer
+  */
+uint8_t CircularBufferShm_Attach(circularBufferShm_TypeDef *targetBuf, const char *name)
+{
+#if defined(CIRCULAR_BUFFER_SHM_POSIX)
+    int fd = shm_open(name, O_RDWR, 0);
+
+    if(fd < 0)      return 1;
+    if(CircularBufferShm_Map(targetBuf, fd) != 0)
+    {
+        close(fd);
+        return 1;
+    }
+    return 0;
+#else
+    (void)targetBuf;
+    (void)name;
+    return 1;
+#endif
+}
+
+/**
+  * @brief  CircularBufferShm_AttachFd() : This function is used to attach a shared-memory circular buffer from a file descriptor.
+  * @param  targetBuf : handle of this process
+  * @param  fd        : segment file descriptor (targetBuf->fd of the creator, inherited or received), owned by the handle on success
+  * @retval 0 -> success
+  *         1 -> error, fd is not a circular buffer segment
+  */
+uint8_t CircularBufferShm_AttachFd(circularBufferShm_TypeDef *targetBuf, int32_t fd)
+{
+    return CircularBufferShm_Map(targetBuf, fd);
+}
+
+/**
+  * @brief  CircularBufferShm_Detach() : This function is used to unmap a shared-memory circular buffer from this process.
+  * @param  targetBuf : handle of this process
+  * @retval None
+  */
+void CircularBufferShm_Detach(circularBufferShm_TypeDef *targetBuf)
+{
+#if defined(CIRCULAR_BUFFER_SHM_POSIX)
+    if(targetBuf->header != NULL)
+    {
+        munmap(targetBuf->header, targetBuf->mapSize);
+        close(targetBuf->fd);
+    }
+#endif
+    targetBuf->header = NULL;
+    targetBuf->fd = -1;
+}
+
+/**
+  * @brief  CircularBufferShm_Unlink() : This function is used to remove the name of a shared-memory circular buffer.
+  *                                     Processes which are attached keep their mapping until CircularBufferShm_Detach().
+  * @param  name : POSIX shared memory name given to CircularBufferShm_Create()
+  * @retval 0 -> success
+  *         1 -> error
+  */
+uint8_t CircularBufferShm_Unlink(const char *name)
+{
+#if defined(CIRCULAR_BUFFER_SHM_POSIX)
+    return (shm_unlink(name) != 0);
+#else
+    (void)name;
+    return 1;
+#endif
+}
+
+/**
+  * @brief  CircularBufferShm_GetCount() : This function is used to get the number of elements in a shared-memory circular buffer.
+  *                                       The result is a snapshot, it can be changed by the other process after return.
+  * @param  targetBuf : handle of this process
+  * @retval number of elements in buffer, 0 -> also if the indices are out of range
+  */
+uint32_t CircularBufferShm_GetCount(circularBufferShm_TypeDef *targetBuf)
+{
+    uint64_t front = atomic_load_explicit(&targetBuf->header->f, memory_order_acquire);
+    uint64_t rear  = atomic_load_explicit(&targetBuf->header->r, memory_order_acquire);
+
+    if(rear - front > targetBuf->bufferSize)    return 0;
+    return (uint32_t)(rear - front);
+}
+
+/**
+  * @brief  CircularBufferShm_Enqueue() : This function is used to "En-queue" an input data into a shared-memory circular buffer.
+  *                                      Must be called from the producer process only. Only the elements which fit are en-queued.
+  * @param  targetBuf    : handle of this process
+  * @param  enqueueData  : enqueued data pointer
+  * @param  enqueueSize  : size of enqueued data (#of element)
+  * @retval number of en-queued elements, 0 -> also if f of the consumer is out of range
+  */
+uint32_t CircularBufferShm_Enqueue(circularBufferShm_TypeDef *targetBuf, const void *enqueueData, uint32_t enqueueSize)
+{
+    circularBufferSpan_TypeDef  span[2];
+    uint64_t                    rear;
+    uint32_t                    freeSize;
+
+    /* r is owned by this process, f is reloaded (acquire) only when the cached f says there is not enough space */
+    rear     = atomic_load_explicit(&targetBuf->header->r, memory_order_relaxed);
+    freeSize = CircularBufferSPSC_GetFreeSize(&targetBuf->header->f, &targetBuf->cachedF, rear, targetBuf->bufferSize, enqueueSize);
+    if(enqueueSize > freeSize)      enqueueSize = freeSize;
+    if(enqueueSize == 0)            return 0;
+
+    /* 1st section (r to end-of-buffer), 2nd section is empty when not wrapping */
+    CircularBufferSPSC_GetSpans(targetBuf->data, targetBuf->elementSize, targetBuf->bufferSize, rear, enqueueSize, span);
+    memcpy(span[0].data, enqueueData, targetBuf->elementSize*span[0].size);
+    memcpy(span[1].data, (const uint8_t *)(enqueueData) + targetBuf->elementSize*span[0].size, targetBuf->elementSize*span[1].size);
+
+    /* Publish the new elements to the consumer */
+    atomic_store_explicit(&targetBuf->header->r, rear + enqueueSize, memory_order_release);
+    return enqueueSize;
+}
+
+/**
+  * @brief  CircularBufferShm_Peek() : This function is used to get the readable region at front of a shared-memory circular buffer, without copying.
+  *                                   Must be called from the consumer process only. span[1].size is 0 if the region is not wrapping.
+  * @param  targetBuf    : handle of this process
+  * @param  span         : output array of 2 spans (addresses in the mapping of this process)
+  * @param  peekSize     : requested size of region (#of element)
+  * @retval size of readable region (limited by number of elements in buffer), 0 -> also if r of the producer is out of range
+  */
+uint32_t CircularBufferShm_Peek(circularBufferShm_TypeDef *targetBuf, circularBufferSpan_TypeDef span[2], uint32_t peekSize)
+{
+    uint64_t front;
+    uint32_t usedSize;
+
+    /* f is owned by this process, r is reloaded (acquire) only when the cached r says there is not enough data */
+    front    = atomic_load_explicit(&targetBuf->header->f, memory_order_relaxed);
+    usedSize = CircularBufferSPSC_GetUsedSize(&targetBuf->header->r, &targetBuf->cachedR, front, targetBuf->bufferSize, peekSize);
+    if(peekSize > usedSize)         peekSize = usedSize;
+
+    CircularBufferSPSC_GetSpans(targetBuf->data, targetBuf->elementSize, targetBuf->bufferSize, front, peekSize, span);
+    return peekSize;
+}
+
+/**
+  * @brief  CircularBufferShm_Consume() : This function is used to "De-queue" elements at front of a shared-memory circular buffer, without copying.
+  *                                      Must be called from the consumer process only, usually after CircularBufferShm_Peek().
+  * @param  targetBuf    : handle of this process
+  * @param  consumeSize  : number of elements to de-queue (#of element)
+  * @retval number of de-queued elements (limited by number of elements in buffer), 0 -> also if r of the producer is out of range
+  */
+uint32_t CircularBufferShm_Consume(circularBufferShm_TypeDef *targetBuf, uint32_t consumeSize)
+{
+    uint64_t front;
+    uint32_t usedSize;
+
+    front    = atomic_load_explicit(&targetBuf->header->f, memory_order_relaxed);
+    usedSize = CircularBufferSPSC_GetUsedSize(&targetBuf->header->r, &targetBuf->cachedR, front, targetBuf->bufferSize, consumeSize);
+    if(consumeSize > usedSize)      consumeSize = usedSize;
+
+    /* Release the slots back to the producer */
+    atomic_store_explicit(&targetBuf->header->f, front + consumeSize, memory_order_release);
+    return consumeSize;
+}
+
+/**
+  * @brief  CircularBufferShm_Dequeue() : This function is used to "De-queue" data from a shared-memory circular buffer.
+  *                                      Must be called from the consumer process only. The de-queued region is not cleared.
+  * @param  targetBuf    : handle of this process
+  * @param  dequeueData  : dequeued data pointer
+  * @param  dequeueSize  : size of dequeued data (#of element)
+  * @retval number of de-queued elements
+  */
+uint32_t CircularBufferShm_Dequeue(circularBufferShm_TypeDef *targetBuf, void *dequeueData, uint32_t dequeueSize)
+{
+    circularBufferSpan_TypeDef  span[2];
+    int8_t                      elementSize = targetBuf->elementSize;
+
+    dequeueSize = CircularBufferShm_Peek(targetBuf, span, dequeueSize);
+    memcpy(dequeueData, span[0].data, elementSize*span[0].size);
+    memcpy((uint8_t *)(dequeueData) + elementSize*span[0].size, span[1].data, elementSize*span[1].size);
+    return CircularBufferShm_Consume(targetBuf, dequeueSize);
+}
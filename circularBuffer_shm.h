@@ -0,0 +1,96 @@
+/**
+  * circularBuffer_shm.h - shared-memory single-producer/single-consumer circular buffer (FIFO) between processes in C (Linux/POSIX).
+  *
+  * To the extent possible under law, the author(s) have dedicated all
+  * copyright and related and neighboring rights to this software to
+  * the public domain worldwide. This software is distributed without
+  * any warranty.
+  *
+  */
+
+#ifndef  __CIRCULARBUFFER_SHM_H
+#define  __CIRCULARBUFFER_SHM_H
+
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdatomic.h>
+
+#include "circularBuffer.h"
+#include "circularBuffer_spsc.h"
+
+/* Identification of a shared-memory segment, checked by CircularBufferShm_Attach() */
+#define     CIRCULAR_BUFFER_SHM_MAGIC       0x43425348u     //"CBSH"
+#define     CIRCULAR_BUFFER_SHM_VERSION     1
+
+/* Header at offset 0 of the segment. Only offsets are stored, each process maps the segment at its own address */
+typedef struct {
+
+    /* Producer cache line : written by producer process only */
+    _Alignas(CIRCULAR_BUFFER_CACHE_LINE_SIZE)
+    _Atomic uint64_t    r;              //rear  (total number of enqueued elements)
+
+    /* Consumer cache line : written by consumer process only */
+    _Alignas(CIRCULAR_BUFFER_CACHE_LINE_SIZE)
+    _Atomic uint64_t    f;              //front (total number of dequeued elements)
+
+    /* Read-only after CircularBufferShm_Create() */
+    _Alignas(CIRCULAR_BUFFER_CACHE_LINE_SIZE)
+    _Atomic uint32_t    magic;          //CIRCULAR_BUFFER_SHM_MAGIC, stored last by the creator
+    uint32_t            version;        //CIRCULAR_BUFFER_SHM_VERSION
+    uint64_t            dataOffset;     //offset of 1-D data array from start of segment (bytes)
+    int32_t             bufferSize;     //buffer size (elements)
+    int8_t              elementSize;    //size per element (bytes)
+
+} circularBufferShmHeader_TypeDef;
+
+/* Process-local handle of a shared-memory buffer */
+typedef struct {
+
+    circularBufferShmHeader_TypeDef *header;    //mapping of the segment in this process
+    size_t              mapSize;        //size of mapping (bytes)
+    int32_t             fd;             //segment file descriptor (can be passed to another process)
+    /* Checked copy of the header geometry, the header is writable by the other process and is not read again */
+    void                *data;          //data array in the mapping of this process
+    uint32_t            bufferSize;     //buffer size (elements)
+    int8_t              elementSize;    //size per element (bytes)
+    uint64_t            cachedR;        //last r seen by consumer, reloaded only when buffer looks empty
+    uint64_t            cachedF;        //last f seen by producer, reloaded only when buffer looks full
+
+} circularBufferShm_TypeDef;
+
+/* Function Prototyping for circularBuffer_shm.h */
+uint8_t  CircularBufferShm_Create   (circularBufferShm_TypeDef *targetBuf,
+                                     const char *name,
+                                     int8_t SetElementSize,
+                                     int32_t SetBufferSize);
+
+uint8_t  CircularBufferShm_Attach   (circularBufferShm_TypeDef *targetBuf,
+                                     const char *name);
+
+uint8_t  CircularBufferShm_AttachFd (circularBufferShm_TypeDef *targetBuf,
+                                     int32_t fd);
+
+void     CircularBufferShm_Detach   (circularBufferShm_TypeDef *targetBuf);
+
+uint8_t  CircularBufferShm_Unlink   (const char *name);
+
+uint32_t CircularBufferShm_Enqueue  (circularBufferShm_TypeDef *targetBuf,
+                                     const void *enqueueData,
+                                     uint32_t enqueueSize);
+
+uint32_t CircularBufferShm_Dequeue  (circularBufferShm_TypeDef *targetBuf,
+                                     void *dequeueData,
+                                     uint32_t dequeueSize);
+
+uint32_t CircularBufferShm_Peek     (circularBufferShm_TypeDef *targetBuf,
+                                     circularBufferSpan_TypeDef span[2],
+                                     uint32_t peekSize);
+
+uint32_t CircularBufferShm_Consume  (circularBufferShm_TypeDef *targetBuf,
+                                     uint32_t consumeSize);
+
+uint32_t CircularBufferShm_GetCount (circularBufferShm_TypeDef *targetBuf);
+
+#endif
@@ -0,0 +1,497 @@
+/**
+  * circularBuffer_spsc.c - lock-free single-producer/single-consumer circular buffer (FIFO) in C.
+  *
+  * To the extent possible under law, the author(s) have dedicated all
+  * copyright and related and neighboring rights to this software to
+  * the public domain worldwide. This software is distributed without
+  * any warranty.
+  *
+  * How to use this file:
+    --------------------
+    + First, you need to declare a FIFO buffer structure with "circularBufferSPSC_TypeDef" type in circularBuffer_spsc.h.
+    + Exactly one thread may en-queue (producer) and exactly one thread may de-queue (consumer).
+      Both threads can run at the same time without any lock.
+    + There're 3 main functions for SPSC circular buffer,
+      1) To En-queue a SPSC circular buffer,    call the function CircularBufferSPSC_Enqueue()  (producer thread)
+      2) To De-queue a SPSC circular buffer,    call the function CircularBufferSPSC_Dequeue()  (consumer thread)
+      3) To initialize a SPSC circular buffer,  call the function CircularBufferSPSC_Init()     (before both threads start)
+
+    + rear:r and front:f are free-running element counters, never wrapped. Element index in buf is (position % bufferSize).
+      r is only written by the producer (release) and read by the consumer (acquire), f is the other way round.
+      So, a consumer never sees an element before its memcpy() is completed, and a producer never overwrites an element before it is de-queued.
+    + Each thread keeps a cached copy of the other thread's index (cachedF, cachedR) in its own cache line. The shared index is
+      only reloaded when the cached value says the buffer is too full (producer) or too empty (consumer), so on a busy stream
+      the cache line of the other thread is not pulled on every call.
+      Define CIRCULAR_BUFFER_SPSC_NO_INDEX_CACHE to always reload it (for comparison, see benchmark_circularBuffer_spsc.c).
+
+    + The consumer can grow or shrink the buffer online with CircularBufferSPSC_Resize(), live data is moved into the new
+      storage in order. The handoff uses a resize epoch : the consumer makes epoch odd, waits until the producer is outside
+      en-queue, moves the data, then makes epoch even again. A producer which enters en-queue during that time waits for
+      the even epoch, then continues with the new storage. No element is lost and the producer never fails because of a resize.
+      A thread parked in a wait function is always woken by a resize, and waits again for its level limited to the new size.
+
+    + Instead of polling CircularBufferSPSC_IsEmpty(), the consumer can call CircularBufferSPSC_WaitForData() to wait for N elements,
+      and the producer can call CircularBufferSPSC_WaitForSpace() to wait for N free elements. The waiting thread spins for a short time,
+      then parks on a futex. The other thread only makes a wake-up system call when a thread is parked and its level is reached.
+**/
+
+#include "circularBuffer_spsc.h"
+#include "circularBuffer_wait.h"
+
+
+/**
+  * @brief  CircularBufferSPSC_Init() : This function is used to "initialize" a SPSC circular buffer struct.
+  * @param  targetBuf      : target circular buffer
+  * @param  pBuf           : pointer of storage buffer array
+  * @param  SetElementSize : size of each element (bytes)
+  * @param  SetBufferSize  : size of buffer (elements)
+  * @retval None
+  */
+void CircularBufferSPSC_Init(circularBufferSPSC_TypeDef *targetBuf, void *pBuf, int8_t SetElementSize, int32_t SetBufferSize)
+{
+    uint32_t InputByteSize;
+
+    targetBuf->buf = pBuf;
+    targetBuf->bufferSize  = SetBufferSize;
+    targetBuf->elementSize = SetElementSize;
+    targetBuf->overflowPolicy = BUF_OVERFLOW_PARTIAL;
+    atomic_init(&targetBuf->r, 0);
+    atomic_init(&targetBuf->f, 0);
+    atomic_init(&targetBuf->writing, 0);
+    atomic_init(&targetBuf->epoch, 0);
+    atomic_init(&targetBuf->publishedSize, (uint32_t)SetBufferSize);
+    targetBuf->cachedF = 0;
+    targetBuf->cachedR = 0;
+    atomic_init(&targetBuf->dataSeq, 0);
+    atomic_init(&targetBuf->dataWaitLevel, 0);
+    atomic_init(&targetBuf->spaceSeq, 0);
+    atomic_init(&targetBuf->spaceWaitLevel, 0);
+    InputByteSize = (targetBuf->elementSize)*(targetBuf->bufferSize);
+    memset(targetBuf->buf, 0, InputByteSize);
+}
+
+/**
+  * @brief  CircularBufferSPSC_Notify() : Wake up the thread parked on futexWord if its wait level is reached, called after r or f is published.
+  * @param  futexWord    : dataSeq or spaceSeq
+  * @param  waitLevel    : dataWaitLevel or spaceWaitLevel
+  * @param  currentLevel : number of elements (for dataSeq) or free elements (for spaceSeq) after publishing
+  * @retval None
+  */
+static void CircularBufferSPSC_Notify(_Atomic uint32_t *futexWord, _Atomic uint32_t *waitLevel, uint32_t currentLevel)
+{
+    uint32_t level;
+
+    /* Pairs with the fence of the waiter : either the waiter sees the new r/f, or this thread sees its wait level.
+       The fence is a full barrier (locked instruction on x86, dmb on ARM) paid by every publish, also without a waiter :
+       fencing only when waitLevel is set would let that load pass the store of r/f, and a waiter parking at the same time
+       would never be woken. Transfers of several elements per call amortize it (see benchmark_circularBuffer_spsc.c) */
+    atomic_thread_fence(memory_order_seq_cst);
+    level = atomic_load_explicit(waitLevel, memory_order_relaxed);
+
+    /* level 0 means nobody is parked, this check is the only cost without a waiter */
+    if((level != 0) && (currentLevel >= level) &&
+       atomic_compare_exchange_strong_explicit(waitLevel, &level, 0, memory_order_relaxed, memory_order_relaxed))
+    {
+        atomic_fetch_add_explicit(futexWord, 1, memory_order_release);
+        CircularBuffer_FutexWake(futexWord);
+    }
+}
+
+/**
+  * @brief  CircularBufferSPSC_GetSize() : Buffer size (elements) for a thread which does not own bufferSize.
+  *                                        It is read outside the resize epoch, so it is never a size in the middle of CircularBufferSPSC_Resize().
+  */
+static uint32_t CircularBufferSPSC_GetSize(circularBufferSPSC_TypeDef *targetBuf)
+{
+    uint32_t spinCount = 0;
+    uint32_t epoch;
+    uint32_t size;
+
+    while(1)
+    {
+        epoch = atomic_load_explicit(&targetBuf->epoch, memory_order_acquire);
+        if((epoch & 1) == 0)
+        {
+            size = atomic_load_explicit(&targetBuf->publishedSize, memory_order_relaxed);
+            atomic_thread_fence(memory_order_acquire);
+            if(atomic_load_explicit(&targetBuf->epoch, memory_order_relaxed) == epoch)     return size;
+        }
+        CircularBuffer_CpuRelax(&spinCount);
+    }
+}
+
+/**
+  * @brief  CircularBufferSPSC_GetWaitLevel() : Level to wait for, waitSize limited to the current buffer size (at least 1).
+  */
+static uint32_t CircularBufferSPSC_GetWaitLevel(circularBufferSPSC_TypeDef *targetBuf, uint32_t waitSize)
+{
+    uint32_t size = CircularBufferSPSC_GetSize(targetBuf);
+
+    if(waitSize > size)     waitSize = size;
+    if(waitSize == 0)       waitSize = 1;
+    return waitSize;
+}
+
+/**
+  * @brief  CircularBufferSPSC_Wait() : Spin, then park on futexWord until getLevel() reaches waitSize, called by the wait functions.
+  *                                     waitSize is limited to the buffer size again on each pass, as a resize may shrink it.
+  * @param  targetBuf    : target circular buffer
+  * @param  futexWord    : dataSeq or spaceSeq
+  * @param  waitLevel    : dataWaitLevel or spaceWaitLevel
+  * @param  getLevel     : CircularBufferSPSC_GetCount or CircularBufferSPSC_GetFree
+  * @param  waitSize     : level to wait for
+  * @param  timeoutMs    : timeout of each park (milliseconds), -1 -> wait forever
+  * @retval 1 -> level is reached
+  *         0 -> timeout
+  */
+static uint8_t CircularBufferSPSC_Wait(circularBufferSPSC_TypeDef *targetBuf, _Atomic uint32_t *futexWord, _Atomic uint32_t *waitLevel,
+                                       uint32_t (*getLevel)(circularBufferSPSC_TypeDef *), uint32_t waitSize, int32_t timeoutMs)
+{
+    uint32_t spinCount = 0;
+    uint32_t i;
+    uint32_t seq;
+    uint32_t level;
+
+    /* Spin for a short time, a busy stream is ready again before parking is worth it */
+    for(i=0; i<CIRCULAR_BUFFER_SPIN_LIMIT; i++)
+    {
+        if(getLevel(targetBuf) >= CircularBufferSPSC_GetWaitLevel(targetBuf, waitSize))     return 1;
+        CircularBuffer_CpuRelax(&spinCount);
+    }
+
+    /* Park until the other thread wakes us up */
+    while(1)
+    {
+        seq = atomic_load_explicit(futexWord, memory_order_acquire);
+        level = CircularBufferSPSC_GetWaitLevel(targetBuf, waitSize);
+        atomic_store_explicit(waitLevel, level, memory_order_relaxed);
+        atomic_thread_fence(memory_order_seq_cst);
+
+        if(getLevel(targetBuf) >= level)
+        {
+            atomic_store_explicit(waitLevel, 0, memory_order_relaxed);
+            return 1;
+        }
+        if(CircularBuffer_FutexWait(futexWord, seq, timeoutMs))
+        {
+            atomic_store_explicit(waitLevel, 0, memory_order_relaxed);
+            return (getLevel(targetBuf) >= CircularBufferSPSC_GetWaitLevel(targetBuf, waitSize));
+        }
+    }
+}
+
+/**
+  * @brief  CircularBufferSPSC_GetFree() : Number of free elements, used by CircularBufferSPSC_WaitForSpace().
+  */
+static uint32_t CircularBufferSPSC_GetFree(circularBufferSPSC_TypeDef *targetBuf)
+{
+    return CircularBufferSPSC_GetSize(targetBuf) - CircularBufferSPSC_GetCount(targetBuf);
+}
+
+/**
+  * @brief  CircularBufferSPSC_WaitForData() : This function is used to wait until a SPSC circular buffer has at least waitSize elements.
+  *                                           Must be called from the consumer thread.
+  * @param  targetBuf : target circular buffer
+  * @param  waitSize  : number of elements to wait for (limited to buffer size)
+  * @param  timeoutMs : maximum time to stay parked without a wake up (milliseconds), -1 -> wait forever
+  * @retval 1 -> data is ready
+  *         0 -> timeout
+  */
+uint8_t CircularBufferSPSC_WaitForData(circularBufferSPSC_TypeDef *targetBuf, uint32_t waitSize, int32_t timeoutMs)
+{
+    return CircularBufferSPSC_Wait(targetBuf, &targetBuf->dataSeq, &targetBuf->dataWaitLevel, CircularBufferSPSC_GetCount, waitSize, timeoutMs);
+}
+
+/**
+  * @brief  CircularBufferSPSC_WaitForSpace() : This function is used to wait until a SPSC circular buffer has at least waitSize free elements.
+  *                                            Must be called from the producer thread.
+  * @param  targetBuf : target circular buffer
+  * @param  waitSize  : number of free elements to wait for (limited to buffer size)
+  * @param  timeoutMs : maximum time to stay parked without a wake up (milliseconds), -1 -> wait forever
+  * @retval 1 -> space is ready
+  *         0 -> timeout
+  */
+uint8_t CircularBufferSPSC_WaitForSpace(circularBufferSPSC_TypeDef *targetBuf, uint32_t waitSize, int32_t timeoutMs)
+{
+    return CircularBufferSPSC_Wait(targetBuf, &targetBuf->spaceSeq, &targetBuf->spaceWaitLevel, CircularBufferSPSC_GetFree, waitSize, timeoutMs);
+}
+
+/**
+  * @brief  CircularBufferSPSC_Flush() : This function is used to discard all data in a SPSC circular buffer.
+  *                                      Must be called from the consumer thread.
+  * @param  targetBuf : target circular buffer
+  * @retval none
+  */
+void CircularBufferSPSC_Flush(circularBufferSPSC_TypeDef *targetBuf)
+{
+    uint64_t rear = atomic_load_explicit(&targetBuf->r, memory_order_acquire);
+
+    targetBuf->cachedR = rear;
+    atomic_store_explicit(&targetBuf->f, rear, memory_order_release);
+    CircularBufferSPSC_Notify(&targetBuf->spaceSeq, &targetBuf->spaceWaitLevel, targetBuf->bufferSize);
+}
+
+/**
+  * @brief  CircularBufferSPSC_GetCount() : This function is used to get the number of elements in a SPSC circular buffer.
+  *                                         The result is a snapshot, it can be changed by the other thread after return.
+  * @param  targetBuf : target circular buffer
+  * @retval number of elements in buffer
+  */
+uint32_t CircularBufferSPSC_GetCount(circularBufferSPSC_TypeDef *targetBuf)
+{
+    uint64_t front = atomic_load_explicit(&targetBuf->f, memory_order_acquire);
+    uint64_t rear  = atomic_load_explicit(&targetBuf->r, memory_order_acquire);
+
+    return (uint32_t)(rear - front);
+}
+
+/**
+  * @brief  CircularBufferSPSC_IsFull() : This function is used to check if a SPSC circular buffer is full or not.
+  * @param  targetBuf : target circular buffer
+  * @retval 0 -> not full
+  *         1 -> full
+  */
+uint8_t CircularBufferSPSC_IsFull(circularBufferSPSC_TypeDef *targetBuf)
+{
+    if(CircularBufferSPSC_GetCount(targetBuf) >= CircularBufferSPSC_GetSize(targetBuf))     return 1;
+    else        return 0;
+}
+
+/**
+  * @brief  CircularBufferSPSC_IsEmpty() : This function is used to check if a SPSC circular buffer is empty or not.
+  * @param  targetBuf : target circular buffer
+  * @retval 0 -> not empty
+  *         1 -> empty
+  */
+uint8_t CircularBufferSPSC_IsEmpty(circularBufferSPSC_TypeDef *targetBuf)
+{
+    if(CircularBufferSPSC_GetCount(targetBuf) == 0)     return 1;
+    else        return 0;
+}
+
+/**
+  * @brief  CircularBufferSPSC_Copy() : Copy as many elements as fit into free space and publish them, called by CircularBufferSPSC_Write().
+  * @param  targetBuf    : target circular buffer
+  * @param  enqueueData  : enqueued data pointer
+  * @param  enqueueSize  : size of enqueued data (#of element)
+  * @param  allOrNothing : 1 -> nothing is written if enqueueSize does not fit
+  * @retval number of en-queued elements
+  */
+static uint32_t CircularBufferSPSC_Copy(circularBufferSPSC_TypeDef *targetBuf, const void *enqueueData, uint32_t enqueueSize, uint8_t allOrNothing)
+{
+    circularBufferSpan_TypeDef  span[2];
+    uint64_t                    rear;
+    uint32_t                    freeSize;
+
+    /* r is owned by this thread, f needs acquire to see the consumer has finished reading the slots.
+       f only grows, so the cached f gives a lower bound of free space, it is reloaded when that is not enough */
+    rear     = atomic_load_explicit(&targetBuf->r, memory_order_relaxed);
+    freeSize = CircularBufferSPSC_GetFreeSize(&targetBuf->f, &targetBuf->cachedF, rear, (uint32_t)targetBuf->bufferSize, enqueueSize);
+    if(enqueueSize > freeSize)
+    {
+        if(allOrNothing)    return 0;
+        enqueueSize = freeSize;
+    }
+    if(enqueueSize == 0)            return 0;
+
+    /* Copy with 1 section, or 2 sections when wrapping */
+    CircularBufferSPSC_GetSpans(targetBuf->buf, targetBuf->elementSize, (uint32_t)targetBuf->bufferSize, rear, enqueueSize, span);
+    memcpy(span[0].data, enqueueData, targetBuf->elementSize*span[0].size);
+    memcpy(span[1].data, (const void *)((const uint8_t *)(enqueueData) + targetBuf->elementSize*span[0].size), targetBuf->elementSize*span[1].size);
+
+    /* Publish the new elements to the consumer */
+    atomic_store_explicit(&targetBuf->r, rear + enqueueSize, memory_order_release);
+    CircularBufferSPSC_Notify(&targetBuf->dataSeq, &targetBuf->dataWaitLevel, (uint32_t)targetBuf->bufferSize - freeSize + enqueueSize);
+
+    return enqueueSize;
+}
+
+/**
+  * @brief  CircularBufferSPSC_Write() : En-queue inside the writer section, called by CircularBufferSPSC_Enqueue().
+  *                                      The writer section is not entered while a resize is moving the data (odd epoch).
+  * @param  targetBuf    : target circular buffer
+  * @param  enqueueData  : enqueued data pointer
+  * @param  enqueueSize  : size of enqueued data (#of element)
+  * @param  allOrNothing : 1 -> nothing is written if enqueueSize does not fit
+  * @retval number of en-queued elements
+  */
+static uint32_t CircularBufferSPSC_Write(circularBufferSPSC_TypeDef *targetBuf, const void *enqueueData, uint32_t enqueueSize, uint8_t allOrNothing)
+{
+    uint32_t spinCount = 0;
+    uint32_t doneSize;
+
+    while(1)
+    {
+        /* Pairs with the fence of CircularBufferSPSC_Resize() : either it sees writing, or this thread sees the odd epoch */
+        atomic_store_explicit(&targetBuf->writing, 1, memory_order_relaxed);
+        atomic_thread_fence(memory_order_seq_cst);
+        if((atomic_load_explicit(&targetBuf->epoch, memory_order_acquire) & 1) == 0)     break;
+
+        atomic_store_explicit(&targetBuf->writing, 0, memory_order_release);
+        while(atomic_load_explicit(&targetBuf->epoch, memory_order_acquire) & 1)
+        {
+            CircularBuffer_CpuRelax(&spinCount);
+        }
+    }
+
+    doneSize = CircularBufferSPSC_Copy(targetBuf, enqueueData, enqueueSize, allOrNothing);
+    atomic_store_explicit(&targetBuf->writing, 0, memory_order_release);
+    return doneSize;
+}
+
+/**
+  * @brief  CircularBufferSPSC_Enqueue() : This function is used to "En-queue" an input data into a SPSC circular buffer.
+  *                                        Must be called from the producer thread only.
+  *                                        When enqueueSize is larger than free space, the result depends on overflow policy of buffer,
+  *                                        see CircularBufferSPSC_SetOverflowPolicy().
+  * @param  targetBuf    : target circular buffer
+  * @param  enqueueData  : enqueued data pointer
+  * @param  enqueueSize  : size of enqueued data (#of element)
+  * @retval number of en-queued elements
+  */
+uint32_t CircularBufferSPSC_Enqueue(circularBufferSPSC_TypeDef *targetBuf, const void *enqueueData, uint32_t enqueueSize)
+{
+    uint32_t doneSize;
+
+    if(targetBuf->overflowPolicy == BUF_OVERFLOW_REJECT)
+    {
+        return CircularBufferSPSC_Write(targetBuf, enqueueData, enqueueSize, 1);
+    }
+    else if(targetBuf->overflowPolicy == BUF_OVERFLOW_BLOCK)
+    {
+        /* Wait for the consumer to release space until all elements are en-queued */
+        doneSize = 0;
+        while(doneSize < enqueueSize)
+        {
+            doneSize += CircularBufferSPSC_Write(targetBuf, (const void *)((const uint8_t *)(enqueueData) + targetBuf->elementSize*doneSize), enqueueSize - doneSize, 0);
+            if(doneSize < enqueueSize)      CircularBufferSPSC_WaitForSpace(targetBuf, enqueueSize - doneSize, -1);
+        }
+        return doneSize;
+    }
+    else
+    {
+        return CircularBufferSPSC_Write(targetBuf, enqueueData, enqueueSize, 0);
+    }
+}
+
+/**
+  * @brief  CircularBufferSPSC_SetOverflowPolicy() : This function is used to select what CircularBufferSPSC_Enqueue() does when data does not fit.
+  *                                                 Call it before both threads start, default policy is BUF_OVERFLOW_PARTIAL.
+  * @param  targetBuf : target circular buffer
+  * @param  policy    : BUF_OVERFLOW_REJECT    -> nothing is en-queued, return 0
+  *                     BUF_OVERFLOW_PARTIAL   -> only the elements which fit are en-queued, the rest is dropped
+  *                     BUF_OVERFLOW_BLOCK     -> producer waits for the consumer until all elements are en-queued
+  *                     BUF_OVERFLOW_OVERWRITE -> not possible without moving f from the producer, works as BUF_OVERFLOW_PARTIAL
+  * @retval None
+  */
+void CircularBufferSPSC_SetOverflowPolicy(circularBufferSPSC_TypeDef *targetBuf, uint8_t policy)
+{
+    targetBuf->overflowPolicy = policy;
+}
+
+/**
+  * @brief  CircularBufferSPSC_Dequeue() : This function is used to "De-queue" data from a SPSC circular buffer.
+  *                                        Must be called from the consumer thread only.
+  *
+  *                                        Warning! : Unlike CircularBuffer_Dequeue(), the de-queued region is not cleared,
+  *                                                   because the slots are owned by the producer as soon as f is published.
+  * @param  targetBuf    : target circular buffer
+  * @param  dequeueData  : dequeued data pointer
+  * @param  dequeueSize  : size of dequeued data (#of element)
+  * @retval number of de-queued elements
+  */
+uint32_t CircularBufferSPSC_Dequeue(circularBufferSPSC_TypeDef *targetBuf, void *dequeueData, uint32_t dequeueSize)
+{
+    circularBufferSpan_TypeDef  span[2];
+    uint64_t                    front;
+    uint32_t                    usedSize;
+
+    /* f is owned by this thread, r needs acquire to see the producer's memcpy().
+       r only grows, so the cached r gives a lower bound of used space, it is reloaded when that is not enough */
+    front    = atomic_load_explicit(&targetBuf->f, memory_order_relaxed);
+    usedSize = CircularBufferSPSC_GetUsedSize(&targetBuf->r, &targetBuf->cachedR, front, (uint32_t)targetBuf->bufferSize, dequeueSize);
+    if(dequeueSize > usedSize)      dequeueSize = usedSize;
+    if(dequeueSize == 0)            return 0;
+
+    /* Copy with 1 section, or 2 sections when wrapping */
+    CircularBufferSPSC_GetSpans(targetBuf->buf, targetBuf->elementSize, (uint32_t)targetBuf->bufferSize, front, dequeueSize, span);
+    memcpy(dequeueData, span[0].data, targetBuf->elementSize*span[0].size);
+    memcpy((void *)((uint8_t *)(dequeueData) + targetBuf->elementSize*span[0].size), span[1].data, targetBuf->elementSize*span[1].size);
+
+    /* Release the slots back to the producer */
+    atomic_store_explicit(&targetBuf->f, front + dequeueSize, memory_order_release);
+    CircularBufferSPSC_Notify(&targetBuf->spaceSeq, &targetBuf->spaceWaitLevel, (uint32_t)targetBuf->bufferSize - (usedSize - dequeueSize));
+
+    return dequeueSize;
+}
+
+/**
+  * @brief  CircularBufferSPSC_Resize() : This function is used to move a SPSC circular buffer into a new storage array of another size.
+  *                                       Elements in buffer are kept in order. Must be called from the consumer thread,
+  *                                       the producer may keep en-queueing (it waits while the data is moved).
+  *                                       The old storage array can be released after return.
+  * @param  targetBuf     : target circular buffer
+  * @param  pNewBuf       : pointer of new storage buffer array
+  * @param  SetBufferSize : new size of buffer (elements)
+  * @retval 0 -> success
+  *         1 -> error, buffer holds more elements than SetBufferSize (nothing is changed)
+  */
+uint8_t CircularBufferSPSC_Resize(circularBufferSPSC_TypeDef *targetBuf, void *pNewBuf, int32_t SetBufferSize)
+{
+    uint32_t spinCount = 0;
+    uint32_t epoch;
+    uint64_t rear;
+    uint64_t front;
+    uint64_t pos;
+    uint32_t oldIndex, newIndex, n;
+    uint8_t  result = 1;
+
+    if(SetBufferSize <= 0)      return 1;
+
+    /* Odd epoch : the producer does not enter en-queue anymore, wait for the one in progress */
+    epoch = atomic_load_explicit(&targetBuf->epoch, memory_order_relaxed);
+    atomic_store_explicit(&targetBuf->epoch, epoch + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    while(atomic_load_explicit(&targetBuf->writing, memory_order_acquire))
+    {
+        CircularBuffer_CpuRelax(&spinCount);
+    }
+
+    front = atomic_load_explicit(&targetBuf->f, memory_order_relaxed);
+    rear  = atomic_load_explicit(&targetBuf->r, memory_order_acquire);
+    if(rear - front <= (uint64_t)SetBufferSize)
+    {
+        /* Positions r,f are kept, element at position p moves from old buf[p % oldSize] to new buf[p % newSize] */
+        for(pos=front; pos<rear; pos+=n)
+        {
+            oldIndex = (uint32_t)(pos % (uint64_t)targetBuf->bufferSize);
+            newIndex = (uint32_t)(pos % (uint64_t)SetBufferSize);
+            n = (uint32_t)(rear - pos);
+            if(n > (uint32_t)targetBuf->bufferSize - oldIndex)     n = (uint32_t)targetBuf->bufferSize - oldIndex;
+            if(n > (uint32_t)SetBufferSize - newIndex)             n = (uint32_t)SetBufferSize - newIndex;
+            memcpy((void *)((uint8_t *)(pNewBuf) + targetBuf->elementSize*newIndex),
+                   (const void *)((uint8_t *)(targetBuf->buf) + targetBuf->elementSize*oldIndex), targetBuf->elementSize*n);
+        }
+        targetBuf->buf = pNewBuf;
+        targetBuf->bufferSize = SetBufferSize;
+        atomic_store_explicit(&targetBuf->publishedSize, (uint32_t)SetBufferSize, memory_order_relaxed);
+        /* The producer is outside en-queue, so its cached f can be updated too. A cached f older than
+           (rear - new size) would give a negative free space after shrinking */
+        targetBuf->cachedF = front;
+        targetBuf->cachedR = rear;
+        result = 0;
+    }
+
+    /* Even epoch : the producer continues with the new buf and bufferSize */
+    atomic_store_explicit(&targetBuf->epoch, epoch + 2, memory_order_release);
+    if(result == 0)
+    {
+        /* Wake every parked thread without checking its level : a level set from the old size may not be reachable anymore,
+           the waiter limits it to the new size and parks again if needed */
+        atomic_fetch_add_explicit(&targetBuf->spaceSeq, 1, memory_order_release);
+        CircularBuffer_FutexWake(&targetBuf->spaceSeq);
+        atomic_fetch_add_explicit(&targetBuf->dataSeq, 1, memory_order_release);
+        CircularBuffer_FutexWake(&targetBuf->dataSeq);
+    }
+    return result;
+}
@@ -0,0 +1,150 @@
+/**
+  * circularBuffer_spsc.h - lock-free single-producer/single-consumer circular buffer (FIFO) in C.
+  *
+  * To the extent possible under law, the author(s) have dedicated all
+  * copyright and related and neighboring rights to this software to
+  * the public domain worldwide. This software is distributed without
+  * any warranty.
+  *
+  */
+
+#ifndef  __CIRCULARBUFFER_SPSC_H
+#define  __CIRCULARBUFFER_SPSC_H
+
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdatomic.h>
+
+#include "circularBuffer.h"
+
+typedef struct {
+
+    /* Producer cache line : written by producer thread only */
+    _Alignas(CIRCULAR_BUFFER_CACHE_LINE_SIZE)
+    _Atomic uint64_t    r;              //rear  (total number of enqueued elements)
+    uint64_t            cachedF;        //last f seen by producer, reloaded only when buffer looks full
+    _Atomic uint32_t    writing;        //1 -> producer is inside en-queue (checked by CircularBufferSPSC_Resize())
+
+    /* Consumer cache line : written by consumer thread only */
+    _Alignas(CIRCULAR_BUFFER_CACHE_LINE_SIZE)
+    _Atomic uint64_t    f;              //front (total number of dequeued elements)
+    uint64_t            cachedR;        //last r seen by consumer, reloaded only when buffer looks empty
+
+    /* Blocking wait cache line : wait level is written by the waiting thread, sequence by the waking thread */
+    _Alignas(CIRCULAR_BUFFER_CACHE_LINE_SIZE)
+    _Atomic uint32_t    dataSeq;        //futex word of consumer waiting for data
+    _Atomic uint32_t    dataWaitLevel;  //number of elements the consumer waits for (0 -> no waiter)
+    _Atomic uint32_t    spaceSeq;       //futex word of producer waiting for space
+    _Atomic uint32_t    spaceWaitLevel; //number of free elements the producer waits for (0 -> no waiter)
+
+    /* Read-mostly : buf and bufferSize are only changed by CircularBufferSPSC_Resize() while epoch is odd */
+    _Alignas(CIRCULAR_BUFFER_CACHE_LINE_SIZE)
+    _Atomic uint32_t    epoch;          //resize epoch, odd -> consumer is moving the data, producer waits
+    _Atomic uint32_t    publishedSize;  //copy of bufferSize for the wait functions, GetFree() and IsFull() (any thread)
+    void                *buf;           //pointer of 1-D data array
+    int32_t             bufferSize;     //buffer size (elements)
+    int8_t              elementSize;    //size per element (bytes)
+    uint8_t             overflowPolicy; //BUF_OVERFLOW_REJECT, BUF_OVERFLOW_PARTIAL or BUF_OVERFLOW_BLOCK
+
+} circularBufferSPSC_TypeDef;
+
+/*
+ * Index protocol of the single-producer/single-consumer buffers, shared by circularBuffer_spsc.c and circularBuffer_shm.c.
+ * r,f are free-running counters, each side owns one and keeps a cached copy of the other. The other index is reloaded with
+ * acquire only when the cached copy says there is not enough space (producer) or data (consumer). An index which is more
+ * than bufferSize away from the own index is out of range (other side misbehaving), it gives 0 free space or 0 elements.
+ */
+
+/**
+  * @brief  CircularBufferSPSC_GetFreeSize() : Free space seen by the producer, f is reloaded into cachedF when wantSize does not fit.
+  */
+static inline uint32_t CircularBufferSPSC_GetFreeSize(_Atomic uint64_t *f, uint64_t *cachedF, uint64_t rear, uint32_t bufferSize, uint32_t wantSize)
+{
+    uint64_t front = *cachedF;
+
+#if !defined(CIRCULAR_BUFFER_SPSC_NO_INDEX_CACHE)
+    if((rear - front) + wantSize > bufferSize)
+#else
+    (void)wantSize;
+#endif
+    {
+        front = atomic_load_explicit(f, memory_order_acquire);
+        *cachedF = front;
+    }
+    if(rear - front > bufferSize)       return 0;
+    return bufferSize - (uint32_t)(rear - front);
+}
+
+/**
+  * @brief  CircularBufferSPSC_GetUsedSize() : Number of elements seen by the consumer, r is reloaded into cachedR when wantSize is not there.
+  */
+static inline uint32_t CircularBufferSPSC_GetUsedSize(_Atomic uint64_t *r, uint64_t *cachedR, uint64_t front, uint32_t bufferSize, uint32_t wantSize)
+{
+    uint64_t rear = *cachedR;
+
+#if !defined(CIRCULAR_BUFFER_SPSC_NO_INDEX_CACHE)
+    if(rear - front < wantSize)
+#else
+    (void)wantSize;
+#endif
+    {
+        rear = atomic_load_explicit(r, memory_order_acquire);
+        *cachedR = rear;
+    }
+    if(rear - front > bufferSize)       return 0;
+    return (uint32_t)(rear - front);
+}
+
+/**
+  * @brief  CircularBufferSPSC_GetSpans() : Region of size elements (size <= bufferSize) from a position, as 2 spans (span[1].size is 0 if not wrapping).
+  */
+static inline void CircularBufferSPSC_GetSpans(void *buf, int8_t elementSize, uint32_t bufferSize, uint64_t position, uint32_t size,
+                                               circularBufferSpan_TypeDef span[2])
+{
+    uint32_t index     = (uint32_t)(position % (uint64_t)bufferSize);
+    uint32_t firstSize = bufferSize - index;
+
+    if(firstSize > size)    firstSize = size;
+    span[0].data = (void *)((uint8_t *)(buf) + elementSize*index);
+    span[0].size = firstSize;
+    span[1].data = buf;
+    span[1].size = size - firstSize;
+}
+
+/* Function Prototyping for circularBuffer_spsc.h */
+uint32_t CircularBufferSPSC_Enqueue (circularBufferSPSC_TypeDef *targetBuf,
+                                     const void *enqueueData,
+                                     uint32_t enqueueSize);
+
+uint32_t CircularBufferSPSC_Dequeue (circularBufferSPSC_TypeDef *targetBuf,
+                                     void *dequeueData,
+                                     uint32_t dequeueSize);
+
+void     CircularBufferSPSC_Init    (circularBufferSPSC_TypeDef *targetBuf,
+                                     void *pBuf,
+                                     int8_t SetElementSize,
+                                     int32_t SetBufferSize);
+
+void     CircularBufferSPSC_SetOverflowPolicy (circularBufferSPSC_TypeDef *targetBuf,
+                                              uint8_t policy);
+
+uint8_t  CircularBufferSPSC_WaitForData  (circularBufferSPSC_TypeDef *targetBuf,
+                                          uint32_t waitSize,
+                                          int32_t timeoutMs);
+
+uint8_t  CircularBufferSPSC_WaitForSpace (circularBufferSPSC_TypeDef *targetBuf,
+                                          uint32_t waitSize,
+                                          int32_t timeoutMs);
+
+uint8_t  CircularBufferSPSC_Resize   (circularBufferSPSC_TypeDef *targetBuf,
+                                     void *pNewBuf,
+                                     int32_t SetBufferSize);
+
+void     CircularBufferSPSC_Flush    (circularBufferSPSC_TypeDef *targetBuf);
+uint32_t CircularBufferSPSC_GetCount (circularBufferSPSC_TypeDef *targetBuf);
+uint8_t  CircularBufferSPSC_IsEmpty  (circularBufferSPSC_TypeDef *targetBuf);
+uint8_t  CircularBufferSPSC_IsFull   (circularBufferSPSC_TypeDef *targetBuf);
+
+#endif
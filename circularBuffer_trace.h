@@ -0,0 +1,68 @@
+/**
+  * circularBuffer_trace.h - static tracepoints (USDT) for circular buffer and frame extraction in C.
+  *
+  * To the extent possible under law, the author(s) have dedicated all
+  * copyright and related and neighboring rights to this software to
+  * the public domain worldwide. This software is distributed without
+  * any warranty.
+  *
+  * How to use this file:
+    --------------------
+    + When <sys/sdt.h> (systemtap-sdt-dev) is available, circularBuffer.c and dsp_frame.c are built with USDT probes
+      of provider "circularBuffer". A probe is a single nop behind a test of its semaphore, the arguments (e.g. the fill
+      level) are only computed while perf or bpftrace is attached to it, e.g.
+
+          bpftrace -e 'usdt:./app:circularBuffer:drop { @dropped[arg0] = sum(arg1); }'
+          perf probe -x ./app sdt_circularBuffer:frame_ready
+
+    + Without <sys/sdt.h>, or with -DCIRCULAR_BUFFER_NO_TRACE, probes compile to nothing (arguments are not evaluated).
+    + All probes have 4 arguments, arg0 is the buffer id (address of circularBuffer_TypeDef), arg3 is the fill level
+      (number of elements in buffer) :
+
+          enqueue     (id, en-queued elements,  dropped elements,           fill after)
+          dequeue     (id, de-queued elements,  requested elements,         fill after)
+          overwrite   (id, overwritten oldest elements, skipped input elements, fill before)
+          drop        (id, dropped elements,    requested elements,         fill before)
+          first_frame (id, frameSize,           overlapSize,                fill before extraction)
+          frame_ready (id, frameSize,           new elements (hop),         fill before extraction)
+**/
+
+#ifndef  __CIRCULARBUFFER_TRACE_H
+#define  __CIRCULARBUFFER_TRACE_H
+
+
+#if !defined(CIRCULAR_BUFFER_NO_TRACE) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#define     _SDT_HAS_SEMAPHORES     1
+#include <sys/sdt.h>
+#define     CIRCULAR_BUFFER_TRACE_SDT
+#endif
+#endif
+
+#if defined(CIRCULAR_BUFFER_TRACE_SDT)
+/* Semaphores : the tracer increments them while attached to a probe, they are defined once in circularBuffer.c */
+#define     CIRCULAR_BUFFER_TRACE_SEMAPHORE(probe)      circularBuffer_##probe##_semaphore
+
+extern volatile unsigned short CIRCULAR_BUFFER_TRACE_SEMAPHORE(enqueue);
+extern volatile unsigned short CIRCULAR_BUFFER_TRACE_SEMAPHORE(dequeue);
+extern volatile unsigned short CIRCULAR_BUFFER_TRACE_SEMAPHORE(overwrite);
+extern volatile unsigned short CIRCULAR_BUFFER_TRACE_SEMAPHORE(drop);
+extern volatile unsigned short CIRCULAR_BUFFER_TRACE_SEMAPHORE(first_frame);
+extern volatile unsigned short CIRCULAR_BUFFER_TRACE_SEMAPHORE(frame_ready);
+
+#define     CIRCULAR_BUFFER_TRACE_ENABLED(probe)        __builtin_expect(CIRCULAR_BUFFER_TRACE_SEMAPHORE(probe) != 0, 0)
+
+/* Arguments are only evaluated while a tracer is attached to the probe */
+#define     CIRCULAR_BUFFER_TRACE(probe, targetBuf, arg1, arg2, fill) \
+    do { \
+        if(CIRCULAR_BUFFER_TRACE_ENABLED(probe)) \
+        { \
+            DTRACE_PROBE4(circularBuffer, probe, (uintptr_t)(targetBuf), (uint32_t)(arg1), (uint32_t)(arg2), (uint32_t)(fill)); \
+        } \
+    } while(0)
+#else
+#define     CIRCULAR_BUFFER_TRACE_ENABLED(probe)                            0
+#define     CIRCULAR_BUFFER_TRACE(probe, targetBuf, arg1, arg2, fill)      do { } while(0)
+#endif
+
+#endif
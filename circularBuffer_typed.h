@@ -0,0 +1,138 @@
+/**
+  * circularBuffer_typed.h - compile-time specialized circular buffer (FIFO) in C.
+  *
+  * To the extent possible under law, the author(s) have dedicated all
+  * copyright and related and neighboring rights to this software to
+  * the public domain worldwide. This software is distributed without
+  * any warranty.
+  *
+  * How to use this file:
+    --------------------
+    + CIRCULAR_BUFFER_DEFINE(name, type, capacity) generates a circular buffer type "name_TypeDef" with a storage array
+      of "capacity" elements of "type", and its functions as static inline :
+
+          name_Init(), name_Enqueue(), name_Dequeue(), name_Put(), name_Get(),
+          name_GetCount(), name_IsEmpty(), name_IsFull(), name_Flush()
+
+      Element size and capacity are constants, so the compiler can reduce index arithmetic and
+      inline fixed-size copies. No modulo is used, an index is wrapped by one compare and subtract.
+    + Example :
+
+          CIRCULAR_BUFFER_DEFINE(SampleRing, _RING_BUFFER_DATA_TYPE, DEFAULT_CIRCULAR_BUFFER_SIZE)
+
+          SampleRing_TypeDef  mySampleRing;
+          SampleRing_Init(&mySampleRing);
+          SampleRing_Put(&mySampleRing, sample);
+
+    + Like circularBuffer_TypeDef, a typed buffer is not thread-safe and elements which do not fit
+      into the free space are not en-queued. Enqueue/Dequeue return the number of transferred elements.
+  */
+
+#ifndef  __CIRCULARBUFFER_TYPED_H
+#define  __CIRCULARBUFFER_TYPED_H
+
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "circularBuffer.h"
+
+#define CIRCULAR_BUFFER_DEFINE(name, type, capacity)                                                    \
+                                                                                                        \
+typedef struct {                                                                                        \
+                                                                                                        \
+    type                buf[(capacity)];    /* 1-D data array */                                        \
+    uint32_t            f;                  /* front index    */                                        \
+    uint32_t            count;              /* number of elements in buffer */                          \
+                                                                                                        \
+} name##_TypeDef;                                                                                       \
+                                                                                                        \
+_Static_assert((capacity) > 0, #name ": capacity must be positive");                                   \
+                                                                                                        \
+static inline void name##_Init(name##_TypeDef *targetBuf)                                               \
+{                                                                                                       \
+    targetBuf->f     = 0;                                                                               \
+    targetBuf->count = 0;                                                                               \
+    memset(targetBuf->buf, 0, sizeof(targetBuf->buf));                                                  \
+}                                                                                                       \
+                                                                                                        \
+static inline void name##_Flush(name##_TypeDef *targetBuf)                                              \
+{                                                                                                       \
+    targetBuf->count = 0;                                                                               \
+}                                                                                                       \
+                                                                                                        \
+static inline uint32_t name##_GetCount(const name##_TypeDef *targetBuf)                                 \
+{                                                                                                       \
+    return targetBuf->count;                                                                            \
+}                                                                                                       \
+                                                                                                        \
+static inline uint8_t name##_IsEmpty(const name##_TypeDef *targetBuf)                                   \
+{                                                                                                       \
+    return targetBuf->count == 0;                                                                       \
+}                                                                                                       \
+                                                                                                        \
+static inline uint8_t name##_IsFull(const name##_TypeDef *targetBuf)                                    \
+{                                                                                                       \
+    return targetBuf->count == (uint32_t)(capacity);                                                    \
+}                                                                                                       \
+                                                                                                        \
+/* Index of element at offset "n" from "index", with n <= capacity */                                   \
+static inline uint32_t name##_Wrap(uint32_t index, uint32_t n)                                          \
+{                                                                                                       \
+    index += n;                                                                                         \
+    if(index >= (uint32_t)(capacity))   index -= (uint32_t)(capacity);                                  \
+    return index;                                                                                       \
+}                                                                                                       \
+                                                                                                        \
+/* En-queue 1 element, return 1 if en-queued or 0 if buffer is full */                                  \
+static inline uint8_t name##_Put(name##_TypeDef *targetBuf, type value)                                 \
+{                                                                                                       \
+    if(targetBuf->count == (uint32_t)(capacity))    return 0;                                           \
+    targetBuf->buf[name##_Wrap(targetBuf->f, targetBuf->count)] = value;                                \
+    targetBuf->count++;                                                                                 \
+    return 1;                                                                                           \
+}                                                                                                       \
+                                                                                                        \
+/* De-queue 1 element, return 1 if de-queued or 0 if buffer is empty */                                 \
+static inline uint8_t name##_Get(name##_TypeDef *targetBuf, type *value)                                \
+{                                                                                                       \
+    if(targetBuf->count == 0)       return 0;                                                           \
+    *value = targetBuf->buf[targetBuf->f];                                                              \
+    targetBuf->f = name##_Wrap(targetBuf->f, 1);                                                        \
+    targetBuf->count--;                                                                                 \
+    return 1;                                                                                           \
+}                                                                                                       \
+                                                                                                        \
+static inline uint32_t name##_Enqueue(name##_TypeDef *targetBuf, const type *enqueueData,              \
+                                      uint32_t enqueueSize)                                             \
+{                                                                                                       \
+    uint32_t index     = name##_Wrap(targetBuf->f, targetBuf->count);                                   \
+    uint32_t firstSize = (uint32_t)(capacity) - index;                                                  \
+                                                                                                        \
+    if(enqueueSize > (uint32_t)(capacity) - targetBuf->count)                                           \
+        enqueueSize = (uint32_t)(capacity) - targetBuf->count;                                          \
+    if(firstSize > enqueueSize)     firstSize = enqueueSize;                                            \
+                                                                                                        \
+    memcpy(&targetBuf->buf[index], enqueueData, firstSize*sizeof(type));                                \
+    memcpy(&targetBuf->buf[0], enqueueData + firstSize, (enqueueSize - firstSize)*sizeof(type));        \
+    targetBuf->count += enqueueSize;                                                                    \
+    return enqueueSize;                                                                                 \
+}                                                                                                       \
+                                                                                                        \
+static inline uint32_t name##_Dequeue(name##_TypeDef *targetBuf, type *dequeueData,                    \
+                                      uint32_t dequeueSize)                                             \
+{                                                                                                       \
+    uint32_t firstSize = (uint32_t)(capacity) - targetBuf->f;                                           \
+                                                                                                        \
+    if(dequeueSize > targetBuf->count)      dequeueSize = targetBuf->count;                             \
+    if(firstSize > dequeueSize)             firstSize = dequeueSize;                                    \
+                                                                                                        \
+    memcpy(dequeueData, &targetBuf->buf[targetBuf->f], firstSize*sizeof(type));                         \
+    memcpy(dequeueData + firstSize, &targetBuf->buf[0], (dequeueSize - firstSize)*sizeof(type));        \
+    targetBuf->f      = name##_Wrap(targetBuf->f, dequeueSize);                                         \
+    targetBuf->count -= dequeueSize;                                                                    \
+    return dequeueSize;                                                                                 \
+}
+
+#endif
@@ -0,0 +1,112 @@
+/**
+  * circularBuffer_wait.c - waiting helpers for the lock-free circular buffers in C.
+  *
+  * To the extent possible under law, the author(s) have dedicated all
+  * copyright and related and neighboring rights to this software to
+  * the public domain worldwide. This software is distributed without
+  * any warranty.
+  *
+  * How to use this file:
+    --------------------
+    + CircularBuffer_CpuRelax()  is one step of a short spin-wait loop.
+    + CircularBuffer_FutexWait() parks the calling thread until another thread calls CircularBuffer_FutexWake()
+      on the same 32-bit word, or the word does not hold the expected value anymore.
+      The waiter reads the word, checks its condition, then waits with the value read. The waker changes
+      the word before waking, so a wake between the check and the wait is never lost.
+    + On non-Linux platforms, waiting falls back to CircularBuffer_CpuRelax() and waking does nothing.
+**/
+
+#if defined(__linux__)
+#define _GNU_SOURCE
+#elif defined(__unix__) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "circularBuffer_wait.h"
+
+#if defined(__unix__)
+#include <sched.h>
+#endif
+
+#if defined(__linux__)
+#include <errno.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+
+/**
+  * @brief  CircularBuffer_CpuRelax() : This function is used as one step of a spin-wait loop.
+  *                                    It hints the CPU first, then gives the core away when the other thread is not running.
+  * @param  spinCount : spin counter of the wait loop (set to 0 before the loop)
+  * @retval None
+  */
+void CircularBuffer_CpuRelax(uint32_t *spinCount)
+{
+    if(++(*spinCount) < CIRCULAR_BUFFER_SPIN_LIMIT)
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+        __asm__ __volatile__("yield");
+#endif
+    }
+    else
+    {
+#if defined(__unix__)
+        sched_yield();
+#endif
+        *spinCount = 0;
+    }
+}
+
+/**
+  * @brief  CircularBuffer_FutexWait() : This function is used to park the calling thread on a 32-bit word.
+  * @param  futexWord     : word to wait on
+  * @param  expectedValue : value of word read before the wait condition was checked
+  * @param  timeoutMs     : timeout (milliseconds), -1 -> wait forever
+  * @retval 0 -> woken up, or word was already changed (check the condition again)
+  *         1 -> timeout
+  */
+uint8_t CircularBuffer_FutexWait(_Atomic uint32_t *futexWord, uint32_t expectedValue, int32_t timeoutMs)
+{
+#if defined(__linux__)
+    struct timespec timeout;
+    long            result;
+
+    timeout.tv_sec  = timeoutMs/1000;
+    timeout.tv_nsec = (long)(timeoutMs%1000)*1000000L;
+
+    result = syscall(SYS_futex, (uint32_t *)futexWord, FUTEX_WAIT_PRIVATE, expectedValue,
+                     (timeoutMs < 0) ? NULL : &timeout, NULL, 0);
+    /* EAGAIN (word already changed) and EINTR are reported as a wake up */
+    if((result != 0) && (errno == ETIMEDOUT))       return 1;
+    return 0;
+#else
+    uint32_t spinCount = 0;
+
+    (void)timeoutMs;
+    while(atomic_load_explicit(futexWord, memory_order_acquire) == expectedValue)
+    {
+        CircularBuffer_CpuRelax(&spinCount);
+    }
+    return 0;
+#endif
+}
+
+/**
+  * @brief  CircularBuffer_FutexWake() : This function is used to wake up all threads parked on a 32-bit word.
+  *                                     The word must be changed before this call.
+  * @param  futexWord : word to wake up
+  * @retval None
+  */
+void CircularBuffer_FutexWake(_Atomic uint32_t *futexWord)
+{
+#if defined(__linux__)
+    syscall(SYS_futex, (uint32_t *)futexWord, FUTEX_WAKE_PRIVATE, INT32_MAX, NULL, NULL, 0);
+#else
+    (void)futexWord;
+#endif
+}
@@ -0,0 +1,30 @@
+/**
+  * circularBuffer_wait.h - waiting helpers for the lock-free circular buffers in C.
+  *
+  * To the extent possible under law, the author(s) have dedicated all
+  * copyright and related and neighboring rights to this software to
+  * the public domain worldwide. This software is distributed without
+  * any warranty.
+  *
+  */
+
+#ifndef  __CIRCULARBUFFER_WAIT_H
+#define  __CIRCULARBUFFER_WAIT_H
+
+
+#include <stdint.h>
+#include <stdatomic.h>
+
+/* Number of spins in a wait loop before the thread yields the CPU */
+#define     CIRCULAR_BUFFER_SPIN_LIMIT      1024
+
+/* Function Prototyping for circularBuffer_wait.h */
+void    CircularBuffer_CpuRelax   (uint32_t *spinCount);
+
+uint8_t CircularBuffer_FutexWait  (_Atomic uint32_t *futexWord,
+                                   uint32_t expectedValue,
+                                   int32_t timeoutMs);
+
+void    CircularBuffer_FutexWake  (_Atomic uint32_t *futexWord);
+
+#endif
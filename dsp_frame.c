@@ -22,9 +22,28 @@
       If circular buffer is ready to frame the next data frame. The next frame will be loaded automatically into the input frame after calling CircularBuffer_IsNextFrameReady().
       If not. Then, the next frame will not be loaded.
 
+    + DSP_frameExtraction_GetNextFrame() can be used instead of DSP_frameExtraction_IsNextFrameReady().
+      It returns a pointer to the frame inside the circular buffer (no copy). The overlap section stays in the buffer,
+      so no previous overlap buffer is needed. If the buffer is mirrored (circularBuffer_mirror.h), a wrapped frame is
+      also returned as one pointer. Otherwise, only a wrapped frame is copied into the frame array.
+      DSP_frameExtraction_PeekNextFrame() is the same without the copy, it returns the frame as 2 spans inside the buffer.
+
+    + First frame and each ready frame have USDT probes first_frame and frame_ready (see circularBuffer_trace.h).
+
 **/
 
 #include "dsp_frame.h"
+#include "circularBuffer_latency.h"
+#include "circularBuffer_trace.h"
+
+
+/**
+  * @brief  DSP_frameExtraction_SetEventLevel() : Make the readiness notification of buffer follow the next frame (see circularBuffer_event.h).
+  */
+static inline void DSP_frameExtraction_SetEventLevel(circularBuffer_TypeDef *targetBuf, uint32_t level)
+{
+    if((targetBuf->event != NULL) && (targetBuf->event->fromFrame))     targetBuf->event->level = level;
+}
 
 /**
   * @brief  DSP_frameExtraction_Init() : This function is used to "initialize" a 1-D signal frame structure for frame extraction.
@@ -49,6 +68,7 @@ void DSP_frameExtraction_Init(dspFrame_TypeDef *targetFrame, void *pFrame, int8_
     targetFrame->elementSize = SetElementSize;
     targetFrame->overlap   = SetOverlap;
     targetFrame->firstFrameCompleteFlag = FIRST_FRAME_IS_NOT_COMPLETED;
+    targetFrame->pendingHop = 0;
 
     InputByteSize = (targetFrame->elementSize)*(targetFrame->frameSize);
     memset(targetFrame->frame, 0, InputByteSize);
@@ -82,11 +102,15 @@ dspFrame_result DSP_frameExtraction_IsNextFrameReady(circularBuffer_TypeDef *tar
     {
         if(targetFrame->firstFrameCompleteFlag == FIRST_FRAME_IS_NOT_COMPLETED)
         {
-            if((targetBuf->r - targetBuf->f >= targetFrame->frameSize) && (targetBuf->f != targetBuf->r))
+            if(CircularBuffer_GetCount(targetBuf) >= (uint32_t)targetFrame->frameSize)
             {
                 dequeueSize = targetFrame->frameSize - targetFrame->overlap;
                 targetFrame->firstFrameCompleteFlag = FIRST_FRAME_IS_COMPLETED;
 
+                // all elements of the first frame are new
+                CIRCULAR_BUFFER_LATENCY_FRAME(targetBuf, 0);
+                CIRCULAR_BUFFER_TRACE(first_frame, targetBuf, targetFrame->frameSize, targetFrame->overlap, CircularBuffer_GetCount(targetBuf));
+
                 //Allocate memory for previous overlap section buffer
                 targetFrame->p_previousOverlap = (void *)(calloc(targetFrame->overlap, targetFrame->elementSize));
                 previousOverlap = targetFrame->p_previousOverlap;
@@ -97,6 +121,9 @@ dspFrame_result DSP_frameExtraction_IsNextFrameReady(circularBuffer_TypeDef *tar
                 // update overlap section
                 memcpy(previousOverlap, (void *)((uint8_t *)(targetFrame->frame) + targetFrame->elementSize*(dequeueSize)), targetFrame->elementSize*(targetFrame->overlap));
 
+                // next frames need only (frameSize - overlapSize) new elements
+                DSP_frameExtraction_SetEventLevel(targetBuf, dequeueSize);
+
                 return FRAME_IS_READY;
             }
             else    return FRAME_IS_NOT_READY;
@@ -105,51 +132,22 @@ dspFrame_result DSP_frameExtraction_IsNextFrameReady(circularBuffer_TypeDef *tar
         {
             dequeueSize = targetFrame->frameSize - targetFrame->overlap;
 
-            if(targetBuf->r > targetBuf->f)
-            {
-                if((targetBuf->r - targetBuf->f) >= (targetFrame->frameSize - targetFrame->overlap))
-                {
-                    previousOverlap = targetFrame->p_previousOverlap;
-                    memcpy(targetFrame->frame, previousOverlap, targetFrame->elementSize*(targetFrame->overlap));
-                    CircularBuffer_Dequeue(targetBuf, (void *)((uint8_t *)(targetFrame->frame) + targetFrame->elementSize*targetFrame->overlap), dequeueSize);
-
-                    // update overlap section
-                    memcpy(previousOverlap, (void *)((uint8_t *)(targetFrame->frame) + targetFrame->elementSize*(dequeueSize)), targetFrame->elementSize*(targetFrame->overlap));
-
-                    return FRAME_IS_READY;
-                }
-                else    return FRAME_IS_NOT_READY;
-            }
-            else if(targetBuf->r < targetBuf->f)
+            if(CircularBuffer_GetCount(targetBuf) >= dequeueSize)
             {
-                if((targetBuf->bufferSize + targetBuf->r - targetBuf->f) >= (targetFrame->frameSize - targetFrame->overlap))
-                {
-                    previousOverlap = targetFrame->p_previousOverlap;
-                    memcpy(targetFrame->frame, previousOverlap, targetFrame->elementSize*(targetFrame->overlap));
-                    CircularBuffer_Dequeue(targetBuf, (void *)((uint8_t *)(targetFrame->frame) + targetFrame->elementSize*targetFrame->overlap), dequeueSize);
-
-                    // update overlap section
-                    memcpy(previousOverlap, (void *)((uint8_t *)(targetFrame->frame) + targetFrame->elementSize*(dequeueSize)), targetFrame->elementSize*(targetFrame->overlap));
-
-                    return FRAME_IS_READY;
-                }
-                else    return FRAME_IS_NOT_READY;
-            }
-            else if(targetBuf->r == targetBuf->f)
-            {
-                if(CircularBuffer_IsFull(targetBuf))
-                {
-                    previousOverlap = targetFrame->p_previousOverlap;
-                    memcpy(targetFrame->frame, previousOverlap, targetFrame->elementSize*(targetFrame->overlap));
-                    CircularBuffer_Dequeue(targetBuf, (void *)((uint8_t *)(targetFrame->frame) + targetFrame->elementSize*targetFrame->overlap), targetFrame->frameSize - targetFrame->overlap);
-
-                    // update overlap section
-                    memcpy(previousOverlap, (void *)((uint8_t *)(targetFrame->frame) + targetFrame->elementSize*(targetFrame->frameSize - targetFrame->overlap)), targetFrame->elementSize*(targetFrame->overlap));
-
-                    return FRAME_IS_READY;
-                }
-                else if(CircularBuffer_IsEmpty(targetBuf))     return FRAME_IS_NOT_READY;
+                // the de-queued hop is the new part of frame
+                CIRCULAR_BUFFER_LATENCY_FRAME(targetBuf, 0);
+                CIRCULAR_BUFFER_TRACE(frame_ready, targetBuf, targetFrame->frameSize, dequeueSize, CircularBuffer_GetCount(targetBuf));
+
+                previousOverlap = targetFrame->p_previousOverlap;
+                memcpy(targetFrame->frame, previousOverlap, targetFrame->elementSize*(targetFrame->overlap));
+                CircularBuffer_Dequeue(targetBuf, (void *)((uint8_t *)(targetFrame->frame) + targetFrame->elementSize*targetFrame->overlap), dequeueSize);
+
+                // update overlap section
+                memcpy(previousOverlap, (void *)((uint8_t *)(targetFrame->frame) + targetFrame->elementSize*(dequeueSize)), targetFrame->elementSize*(targetFrame->overlap));
+
+                return FRAME_IS_READY;
             }
+            else    return FRAME_IS_NOT_READY;
         }
     }
 
@@ -157,3 +155,87 @@ dspFrame_result DSP_frameExtraction_IsNextFrameReady(circularBuffer_TypeDef *tar
     return FRAME_ERROR;
 }
 
+
+/**
+  * @brief  DSP_frameExtraction_PeekNextFrame() : This function is used to get the next data frame as 2 spans inside the buffer, without copying.
+  *                                               Framing, readiness notification, latency and tracepoints are the same as
+  *                                               DSP_frameExtraction_GetNextFrame(), which is built on it (also the float variant
+  *                                               DSP_frameExtraction_GetNextFrameFloat() of circularBuffer_convert.h).
+  *                                               span[1].size is 0 if the frame is not wrapping (always for mirrored buffer).
+  *
+  *                                               Warning! : Same restrictions as DSP_frameExtraction_GetNextFrame().
+  * @param  targetBuf    : circular buffer structure
+  * @param  targetFrame  : frame structure (frame array is not used)
+  * @param  span         : output array of 2 spans, frameSize elements in total
+  * @retval FRAME_IS_READY      -> ready
+  *         FRAME_IS_NOT_READY  -> not ready
+  *         FRAME_ERROR         -> error
+  */
+dspFrame_result DSP_frameExtraction_PeekNextFrame(circularBuffer_TypeDef *targetBuf, dspFrame_TypeDef *targetFrame, circularBufferSpan_TypeDef span[2])
+{
+    if(targetFrame->elementSize != targetBuf->elementSize)
+    {
+        return FRAME_ERROR;	//error
+    }
+
+    // release the hop of previous frame, the overlap section is kept in buffer
+    CircularBuffer_Consume(targetBuf, targetFrame->pendingHop);
+    targetFrame->pendingHop = 0;
+    DSP_frameExtraction_SetEventLevel(targetBuf, targetFrame->frameSize);
+
+    if(CircularBuffer_Peek(targetBuf, span, targetFrame->frameSize) < (uint32_t)targetFrame->frameSize)     return FRAME_IS_NOT_READY;
+
+    // the overlap section was already in the previous frame, except for the first frame
+    CIRCULAR_BUFFER_LATENCY_FRAME(targetBuf, (targetFrame->firstFrameCompleteFlag == FIRST_FRAME_IS_COMPLETED) ? targetFrame->overlap : 0);
+    if(targetFrame->firstFrameCompleteFlag == FIRST_FRAME_IS_COMPLETED)
+    {
+        CIRCULAR_BUFFER_TRACE(frame_ready, targetBuf, targetFrame->frameSize, targetFrame->frameSize - targetFrame->overlap, CircularBuffer_GetCount(targetBuf));
+    }
+    else
+    {
+        CIRCULAR_BUFFER_TRACE(first_frame, targetBuf, targetFrame->frameSize, targetFrame->overlap, CircularBuffer_GetCount(targetBuf));
+    }
+
+    targetFrame->firstFrameCompleteFlag = FIRST_FRAME_IS_COMPLETED;
+    targetFrame->pendingHop = targetFrame->frameSize - targetFrame->overlap;
+
+    // the pending hop is still in buffer, next frame is ready at (frameSize + hop) elements
+    DSP_frameExtraction_SetEventLevel(targetBuf, targetFrame->frameSize + targetFrame->pendingHop);
+    return FRAME_IS_READY;
+}
+
+/**
+  * @brief  DSP_frameExtraction_GetNextFrame() : This function is used to get a pointer of the next data frame, without copying it out of buffer.
+  *                                              The frame stays valid until the next call, or until the buffer is en-queued.
+  *                                              Its first (frameSize - overlapSize) elements are released from buffer on the next call.
+  *
+  *                                              Warning! : Do not mix with DSP_frameExtraction_IsNextFrameReady() or CircularBuffer_Dequeue()
+  *                                                         on the same buffer. Released elements are not cleared.
+  * @param  targetBuf    : circular buffer structure
+  * @param  targetFrame  : frame structure (frame array is only used for a wrapped frame of non-mirrored buffer)
+  * @param  ppFrame      : output pointer of the next frame
+  * @retval FRAME_IS_READY      -> ready, *ppFrame points to frameSize elements
+  *         FRAME_IS_NOT_READY  -> not ready
+  *         FRAME_ERROR         -> error
+  */
+dspFrame_result DSP_frameExtraction_GetNextFrame(circularBuffer_TypeDef *targetBuf, dspFrame_TypeDef *targetFrame, const void **ppFrame)
+{
+    circularBufferSpan_TypeDef  span[2];
+    dspFrame_result             result = DSP_frameExtraction_PeekNextFrame(targetBuf, targetFrame, span);
+
+    if(result != FRAME_IS_READY)    return result;
+
+    if(span[1].size == 0)
+    {
+        // contiguous frame (always for mirrored buffer)
+        *ppFrame = span[0].data;
+    }
+    else
+    {
+        // wrapped frame : copy with 2 sections into frame array
+        memcpy(targetFrame->frame, span[0].data, targetFrame->elementSize*span[0].size);
+        memcpy((void *)((uint8_t *)(targetFrame->frame) + targetFrame->elementSize*span[0].size), span[1].data, targetFrame->elementSize*span[1].size);
+        *ppFrame = targetFrame->frame;
+    }
+    return FRAME_IS_READY;
+}
@@ -43,6 +43,7 @@ typedef struct
     int8_t      elementSize;    //size per element (bytes)
     uint8_t 	firstFrameCompleteFlag;      //1st frame flag
     void        *p_previousOverlap;          //pointer of previous overlap buffer (with allocated memory)
+    uint32_t    pendingHop;                 //elements to release from buffer before next DSP_frameExtraction_GetNextFrame()
 
 } dspFrame_TypeDef;
 
@@ -54,4 +55,12 @@ void    DSP_frameExtraction_Init(dspFrame_TypeDef *targetFrame,
 
 dspFrame_result  DSP_frameExtraction_IsNextFrameReady(circularBuffer_TypeDef *targetBuf, dspFrame_TypeDef *targetFrame);
 
+dspFrame_result  DSP_frameExtraction_PeekNextFrame(circularBuffer_TypeDef *targetBuf,
+                                                   dspFrame_TypeDef *targetFrame,
+                                                   circularBufferSpan_TypeDef span[2]);
+
+dspFrame_result  DSP_frameExtraction_GetNextFrame(circularBuffer_TypeDef *targetBuf,
+                                                  dspFrame_TypeDef *targetFrame,
+                                                  const void **ppFrame);
+
 #endif /* dsp_frame.h */
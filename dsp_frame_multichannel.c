@@ -0,0 +1,231 @@
+/**
+  * dsp_frame_multichannel.c : interleaved multichannel signal frame extraction in C.
+  *
+  * To the extent possible under law, the author(s) have dedicated all
+  * copyright and related and neighboring rights to this software to
+  * the public domain worldwide. This software is distributed without
+  * any warranty.
+  *
+  *
+  * How to use this file:
+    --------------------
+    + One circular buffer holds all channels, interleaved as they come from the sensor :
+
+          | s0[ch0] s0[ch1] .. s0[chN-1] | s1[ch0] s1[ch1] .. | ...      (one sample frame = 1 sample of each channel)
+
+      Initialize it with DSP_multichannel_InitBuffer(), and en-queue whole sample frames with DSP_multichannel_Enqueue().
+      Samples are 32-bit (_RING_BUFFER_DATA_TYPE or float).
+    + DSP_multichannel_GetNextFrame() extracts the next frame of all channels into a planar array (structure-of-arrays),
+      one row of frameSize samples per channel, ready for per-channel DSP :
+
+          planar[0*frameSize .. 1*frameSize-1] = channel 0
+          planar[1*frameSize .. 2*frameSize-1] = channel 1 ...
+
+      The samples are read from the buffer and deinterleaved in the same copy, there is no separate deinterleave pass.
+      Like DSP_frameExtraction_GetNextFrame(), the overlap section stays in the buffer.
+    + The deinterleave uses SSE2 or NEON shuffles when channels is 2 or a multiple of 4 (4x4 transpose blocks),
+      and a scalar loop for other channel counts.
+
+**/
+
+#include "dsp_frame_multichannel.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+
+/**
+  * @brief  DSP_multichannel_InitBuffer() : This function is used to "initialize" a circular buffer for interleaved multichannel samples.
+  * @param  targetBuf      : target circular buffer
+  * @param  pBuf           : pointer of storage buffer array (channels*SetFrameCount samples of 32 bits)
+  * @param  channels       : number of interleaved channels
+  * @param  SetFrameCount  : size of buffer (sample frames)
+  * @retval 0 -> success
+  *         1 -> error, invalid size
+  */
+uint8_t DSP_multichannel_InitBuffer(circularBuffer_TypeDef *targetBuf, void *pBuf, uint32_t channels, int32_t SetFrameCount)
+{
+    int32_t bufferSize;
+
+    if((channels == 0) || (SetFrameCount <= 0) || ((uint64_t)channels*(uint64_t)SetFrameCount > INT32_MAX))     return 1;
+
+    /* Buffer size is a multiple of channels, so a wrap never splits a sample frame */
+    bufferSize = (int32_t)(channels*(uint32_t)SetFrameCount);
+    if(CircularBuffer_InitPow2(targetBuf, pBuf, sizeof(_RING_BUFFER_DATA_TYPE), bufferSize) != 0)
+    {
+        CircularBuffer_Init(targetBuf, pBuf, sizeof(_RING_BUFFER_DATA_TYPE), bufferSize);
+    }
+    return 0;
+}
+
+/**
+  * @brief  DSP_multichannel_Enqueue() : This function is used to "En-queue" interleaved sample frames into a multichannel circular buffer.
+  *                                      Only whole sample frames which fit are en-queued.
+  * @param  targetBuf    : target circular buffer from DSP_multichannel_InitBuffer()
+  * @param  channels     : number of interleaved channels
+  * @param  enqueueData  : interleaved samples
+  * @param  frameCount   : number of sample frames
+  * @retval number of en-queued sample frames
+  */
+uint32_t DSP_multichannel_Enqueue(circularBuffer_TypeDef *targetBuf, uint32_t channels, const void *enqueueData, uint32_t frameCount)
+{
+    uint32_t freeFrames = ((uint32_t)targetBuf->bufferSize - CircularBuffer_GetCount(targetBuf))/channels;
+
+    if(frameCount > freeFrames)     frameCount = freeFrames;
+    return CircularBuffer_Enqueue(targetBuf, enqueueData, frameCount*channels)/channels;
+}
+
+/**
+  * @brief  DSP_multichannel_InitFrame() : This function is used to "initialize" a planar multichannel frame structure for frame extraction.
+  * @param  targetFrame     : target frame structure
+  * @param  pPlanar         : pointer of planar frame array (channels*SetFrameSize samples of 32 bits)
+  * @param  channels        : number of interleaved channels
+  * @param  SetFrameSize    : size of frame (samples per channel)
+  * @param  SetOverlap      : overlap size (samples per channel), less than SetFrameSize
+  * @retval None
+  */
+void DSP_multichannel_InitFrame(dspFrameMultichannel_TypeDef *targetFrame, void *pPlanar, uint32_t channels, int32_t SetFrameSize, int32_t SetOverlap)
+{
+    targetFrame->planar     = (int32_t *)pPlanar;
+    targetFrame->frameSize  = SetFrameSize;
+    targetFrame->overlap    = SetOverlap;
+    targetFrame->channels   = channels;
+    targetFrame->pendingHop = 0;
+
+    memset(targetFrame->planar, 0, sizeof(int32_t)*channels*SetFrameSize);
+}
+
+/**
+  * @brief  DSP_multichannel_Deinterleave() : This function is used to copy interleaved sample frames into planar rows.
+  * @param  src         : interleaved samples (frameCount*channels)
+  * @param  frameCount  : number of sample frames
+  * @param  channels    : number of interleaved channels
+  * @param  planar      : 1st output sample of channel 0, channel c is written at planar[c*planeStride]
+  * @param  planeStride : distance between rows of 2 channels (samples)
+  * @retval None
+  */
+void DSP_multichannel_Deinterleave(const int32_t *src, uint32_t frameCount, uint32_t channels, int32_t *planar, uint32_t planeStride)
+{
+    uint32_t t = 0;
+    uint32_t c;
+
+#if defined(__SSE2__)
+    if(channels == 2)
+    {
+        /* l0 r0 l1 r1 | l2 r2 l3 r3 -> l0 l1 l2 l3 | r0 r1 r2 r3 */
+        for(; t+4<=frameCount; t+=4)
+        {
+            __m128 a = _mm_castsi128_ps(_mm_loadu_si128((const __m128i *)(src + 2*t)));
+            __m128 b = _mm_castsi128_ps(_mm_loadu_si128((const __m128i *)(src + 2*t + 4)));
+            _mm_storeu_si128((__m128i *)(planar + t),               _mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0))));
+            _mm_storeu_si128((__m128i *)(planar + planeStride + t), _mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1))));
+        }
+    }
+    else if((channels & 3) == 0)
+    {
+        /* 4 sample frames x 4 channels are transposed in registers */
+        for(; t+4<=frameCount; t+=4)
+        {
+            const int32_t *s = src + t*channels;
+
+            for(c=0; c<channels; c+=4)
+            {
+                __m128i r0 = _mm_loadu_si128((const __m128i *)(s + c));
+                __m128i r1 = _mm_loadu_si128((const __m128i *)(s + channels + c));
+                __m128i r2 = _mm_loadu_si128((const __m128i *)(s + 2*channels + c));
+                __m128i r3 = _mm_loadu_si128((const __m128i *)(s + 3*channels + c));
+                __m128i t0 = _mm_unpacklo_epi32(r0, r1);        //a0 b0 a1 b1
+                __m128i t1 = _mm_unpackhi_epi32(r0, r1);        //a2 b2 a3 b3
+                __m128i t2 = _mm_unpacklo_epi32(r2, r3);        //c0 d0 c1 d1
+                __m128i t3 = _mm_unpackhi_epi32(r2, r3);        //c2 d2 c3 d3
+                int32_t *p = planar + c*planeStride + t;
+
+                _mm_storeu_si128((__m128i *)(p),                 _mm_unpacklo_epi64(t0, t2));
+                _mm_storeu_si128((__m128i *)(p + planeStride),   _mm_unpackhi_epi64(t0, t2));
+                _mm_storeu_si128((__m128i *)(p + 2*planeStride), _mm_unpacklo_epi64(t1, t3));
+                _mm_storeu_si128((__m128i *)(p + 3*planeStride), _mm_unpackhi_epi64(t1, t3));
+            }
+        }
+    }
+#elif defined(__ARM_NEON)
+    if(channels == 2)
+    {
+        for(; t+4<=frameCount; t+=4)
+        {
+            int32x4x2_t v = vld2q_s32(src + 2*t);
+
+            vst1q_s32(planar + t,               v.val[0]);
+            vst1q_s32(planar + planeStride + t, v.val[1]);
+        }
+    }
+    else if((channels & 3) == 0)
+    {
+        for(; t+4<=frameCount; t+=4)
+        {
+            const int32_t *s = src + t*channels;
+
+            for(c=0; c<channels; c+=4)
+            {
+                int32x4x2_t t01 = vtrnq_s32(vld1q_s32(s + c),              vld1q_s32(s + channels + c));       //a0 b0 a2 b2 | a1 b1 a3 b3
+                int32x4x2_t t23 = vtrnq_s32(vld1q_s32(s + 2*channels + c), vld1q_s32(s + 3*channels + c));     //c0 d0 c2 d2 | c1 d1 c3 d3
+                int32_t     *p  = planar + c*planeStride + t;
+
+                vst1q_s32(p,                 vcombine_s32(vget_low_s32(t01.val[0]),  vget_low_s32(t23.val[0])));
+                vst1q_s32(p + planeStride,   vcombine_s32(vget_low_s32(t01.val[1]),  vget_low_s32(t23.val[1])));
+                vst1q_s32(p + 2*planeStride, vcombine_s32(vget_high_s32(t01.val[0]), vget_high_s32(t23.val[0])));
+                vst1q_s32(p + 3*planeStride, vcombine_s32(vget_high_s32(t01.val[1]), vget_high_s32(t23.val[1])));
+            }
+        }
+    }
+#endif
+
+    /* Other channel counts, and the remaining sample frames */
+    for(; t<frameCount; t++)
+    {
+        for(c=0; c<channels; c++)
+        {
+            planar[c*planeStride + t] = src[t*channels + c];
+        }
+    }
+}
+
+/**
+  * @brief  DSP_multichannel_GetNextFrame() : This function is used to extract the next planar frame of all channels from a multichannel buffer.
+  *                                           Samples are deinterleaved while they are copied out of the buffer.
+  *
+  *                                           Warning! : Do not mix with CircularBuffer_Dequeue() on the same buffer.
+  * @param  targetBuf    : circular buffer from DSP_multichannel_InitBuffer()
+  * @param  targetFrame  : planar frame structure
+  * @retval FRAME_IS_READY      -> ready, planar array holds the next frame
+  *         FRAME_IS_NOT_READY  -> not ready
+  *         FRAME_ERROR         -> error
+  */
+dspFrame_result DSP_multichannel_GetNextFrame(circularBuffer_TypeDef *targetBuf, dspFrameMultichannel_TypeDef *targetFrame)
+{
+    circularBufferSpan_TypeDef  span[2];
+    uint32_t                    channels = targetFrame->channels;
+    uint32_t                    frameSamples = channels*(uint32_t)targetFrame->frameSize;
+    uint32_t                    firstFrames;
+
+    if((targetBuf->elementSize != sizeof(int32_t)) || ((uint32_t)targetBuf->bufferSize % channels != 0))
+    {
+        return FRAME_ERROR;	//error
+    }
+
+    // release the hop of previous frame, the overlap section is kept in buffer
+    CircularBuffer_Consume(targetBuf, targetFrame->pendingHop*channels);
+    targetFrame->pendingHop = 0;
+
+    if(CircularBuffer_Peek(targetBuf, span, frameSamples) < frameSamples)   return FRAME_IS_NOT_READY;
+
+    // deinterleave with 1 section, or 2 sections when wrapping (always at a sample frame boundary)
+    firstFrames = span[0].size/channels;
+    DSP_multichannel_Deinterleave((const int32_t *)span[0].data, firstFrames, channels, targetFrame->planar, targetFrame->frameSize);
+    DSP_multichannel_Deinterleave((const int32_t *)span[1].data, span[1].size/channels, channels, targetFrame->planar + firstFrames, targetFrame->frameSize);
+
+    targetFrame->pendingHop = targetFrame->frameSize - targetFrame->overlap;
+    return FRAME_IS_READY;
+}
@@ -0,0 +1,55 @@
+/**
+  * dsp_frame_multichannel.h : interleaved multichannel signal frame extraction in C.
+  *
+  * To the extent possible under law, the author(s) have dedicated all
+  * copyright and related and neighboring rights to this software to
+  * the public domain worldwide. This software is distributed without
+  * any warranty.
+  *
+  */
+
+#ifndef  __DSP_FRAME_MULTICHANNEL_H
+#define  __DSP_FRAME_MULTICHANNEL_H
+
+#include "circularBuffer.h"
+#include "dsp_frame.h"
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+typedef struct
+{
+    int32_t     *planar;        //planar frame (channels*frameSize samples), channel c at planar[c*frameSize]
+    int32_t     frameSize;      //frame size    (samples per channel)
+    int32_t     overlap;        //overlap size  (samples per channel)
+    uint32_t    channels;       //number of interleaved channels
+    uint32_t    pendingHop;     //sample frames to release from buffer before next DSP_multichannel_GetNextFrame()
+
+} dspFrameMultichannel_TypeDef;
+
+uint8_t  DSP_multichannel_InitBuffer(circularBuffer_TypeDef *targetBuf,
+                                     void *pBuf,
+                                     uint32_t channels,
+                                     int32_t SetFrameCount);
+
+uint32_t DSP_multichannel_Enqueue(circularBuffer_TypeDef *targetBuf,
+                                  uint32_t channels,
+                                  const void *enqueueData,
+                                  uint32_t frameCount);
+
+void     DSP_multichannel_InitFrame(dspFrameMultichannel_TypeDef *targetFrame,
+                                    void *pPlanar,
+                                    uint32_t channels,
+                                    int32_t SetFrameSize,
+                                    int32_t SetOverlap);
+
+dspFrame_result DSP_multichannel_GetNextFrame(circularBuffer_TypeDef *targetBuf,
+                                              dspFrameMultichannel_TypeDef *targetFrame);
+
+void     DSP_multichannel_Deinterleave(const int32_t *src,
+                                       uint32_t frameCount,
+                                       uint32_t channels,
+                                       int32_t *planar,
+                                       uint32_t planeStride);
+
+#endif /* dsp_frame_multichannel.h */
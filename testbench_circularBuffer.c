@@ -0,0 +1,1078 @@
+/**
+  * testbench_circularBuffer.c : Edge cases of the circular buffers (full, wrap, contention, resize), checked without user input.
+  *
+  * Build : gcc -O2 -pthread testbench_circularBuffer.c circularBuffer.c circularBuffer_spsc.c circularBuffer_wait.c \
+  *             circularBuffer_record.c circularBuffer_mpmc.c circularBuffer_broadcast.c circularBuffer_persist.c \
+  *             circularBuffer_shm.c circularBuffer_convert.c dsp_frame.c circularBuffer_alloc.c circularBuffer_mirror.c \
+  *             -o testbench_circularBuffer
+  *
+  *         Each case prints PASS or FAIL, the exit code is the number of failed cases.
+  *         A case which would hang (lost wake up) is reported as FAIL after TIMEOUT_MS.
+  */
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "circularBuffer.h"
+#include "circularBuffer_spsc.h"
+#include "circularBuffer_record.h"
+#include "circularBuffer_mpmc.h"
+#include "circularBuffer_broadcast.h"
+#include "circularBuffer_persist.h"
+#include "circularBuffer_shm.h"
+#include "circularBuffer_convert.h"
+#include "circularBuffer_alloc.h"
+#include "circularBuffer_mirror.h"
+
+#define     TIMEOUT_MS              2000
+
+static void sleepMs(uint32_t ms)
+{
+    struct timespec t;
+
+    t.tv_sec  = ms/1000;
+    t.tv_nsec = (long)(ms%1000)*1000000L;
+    nanosleep(&t, NULL);
+}
+
+/* Wait for a flag set by another thread, 0 -> timeout */
+static int waitFlag(_Atomic int *flag)
+{
+    uint32_t i;
+
+    for(i=0; i<TIMEOUT_MS; i++)
+    {
+        if(atomic_load(flag))   return 1;
+        sleepMs(1);
+    }
+    return 0;
+}
+
+static int report(const char *name, int failed)
+{
+    printf("%-48s %s\n", name, failed ? "FAIL" : "PASS");
+    return failed;
+}
+
+
+/*
+ * Power-of-two buffer : sizes which are not a power of two are refused. Positions start just below 2^32, so the 64-bit
+ * rPos,fPos and the mask are checked across the 32-bit boundary, with data wrapping at the end of storage.
+ */
+#define     POW2_RING_LENGTH        16
+
+static int testPow2WrapAndCapacity(void)
+{
+    circularBuffer_TypeDef  myPow2Ring;
+    _RING_BUFFER_DATA_TYPE  storage[POW2_RING_LENGTH];
+    _RING_BUFFER_DATA_TYPE  data[2*POW2_RING_LENGTH];
+    int32_t                 i;
+    int                     failed = 0;
+
+    for(i=0; i<2*POW2_RING_LENGTH; i++)     data[i] = i;
+    if(CircularBuffer_InitPow2(&myPow2Ring, storage, sizeof(_RING_BUFFER_DATA_TYPE), 12) != 1)       failed = 1;
+    if(CircularBuffer_InitPow2(&myPow2Ring, storage, 3, POW2_RING_LENGTH) != 1)                       failed = 1;
+    if(CircularBuffer_InitPow2(&myPow2Ring, storage, sizeof(_RING_BUFFER_DATA_TYPE), POW2_RING_LENGTH) != 0)     failed = 1;
+    if(myPow2Ring.mode != BUF_MODE_POW2)    failed = 1;
+
+    /* 5 elements before the 32-bit boundary, index 11 of storage */
+    myPow2Ring.rPos = ((uint64_t)1 << 32) - 5;
+    myPow2Ring.fPos = myPow2Ring.rPos;
+
+    /* Full and empty at exactly bufferSize elements */
+    if(CircularBuffer_Enqueue(&myPow2Ring, data, POW2_RING_LENGTH) != POW2_RING_LENGTH)    failed = 1;
+    if(!CircularBuffer_IsFull(&myPow2Ring) || (CircularBuffer_GetCount(&myPow2Ring) != POW2_RING_LENGTH))     failed = 1;
+    if(CircularBuffer_Enqueue(&myPow2Ring, data, 1) != 0)                                  failed = 1;
+    if(storage[11] != 0)    failed = 1;
+
+    /* Wrap : 10 out, 10 in, then all 16 out in order */
+    if(CircularBuffer_Dequeue(&myPow2Ring, data + POW2_RING_LENGTH, 10) != 10)            failed = 1;
+    for(i=0; i<10; i++)
+    {
+        if(data[POW2_RING_LENGTH + i] != i)     failed = 1;
+    }
+    for(i=0; i<10; i++)     data[i] = POW2_RING_LENGTH + i;
+    if(CircularBuffer_Enqueue(&myPow2Ring, data, 10) != 10)                                failed = 1;
+    if(!CircularBuffer_IsFull(&myPow2Ring))     failed = 1;
+    if(CircularBuffer_Dequeue(&myPow2Ring, data + POW2_RING_LENGTH, 2*POW2_RING_LENGTH) != POW2_RING_LENGTH)   failed = 1;
+    for(i=0; i<POW2_RING_LENGTH; i++)
+    {
+        if(data[POW2_RING_LENGTH + i] != 10 + i)    failed = 1;
+    }
+    if(!CircularBuffer_IsEmpty(&myPow2Ring) || (CircularBuffer_GetCount(&myPow2Ring) != 0))    failed = 1;
+    if(myPow2Ring.fPos != ((uint64_t)1 << 32) + 21)     failed = 1;
+
+    return report("Pow2 buffer full/empty and wrap at 2^32", failed);
+}
+
+
+/*
+ * Overflow policies of CircularBuffer_Enqueue() : REJECT writes nothing, PARTIAL writes what fits, OVERWRITE keeps the
+ * newest bufferSize elements and moves front. The readiness notification is signalled only when the count crosses its level,
+ * not by an overwrite of a full buffer.
+ */
+#define     POLICY_RING_LENGTH      8
+#define     POLICY_EVENT_LEVEL      6
+
+static uint32_t policySignalCount;
+
+static void policySignal(circularBufferEvent_TypeDef *event)
+{
+    (void)event;
+    policySignalCount++;
+}
+
+static int checkSequence(const _RING_BUFFER_DATA_TYPE *data, uint32_t size, _RING_BUFFER_DATA_TYPE first)
+{
+    uint32_t i;
+
+    for(i=0; i<size; i++)
+    {
+        if(data[i] != first + (_RING_BUFFER_DATA_TYPE)i)    return 1;
+    }
+    return 0;
+}
+
+static int testOverflowPolicies(void)
+{
+    circularBuffer_TypeDef      myPolicyRing;
+    circularBufferEvent_TypeDef event;
+    _RING_BUFFER_DATA_TYPE      storage[POLICY_RING_LENGTH];
+    _RING_BUFFER_DATA_TYPE      data[2*POLICY_RING_LENGTH];
+    _RING_BUFFER_DATA_TYPE      out[2*POLICY_RING_LENGTH];
+    int32_t                     i;
+    int                         failed = 0;
+
+    for(i=0; i<2*POLICY_RING_LENGTH; i++)   data[i] = i;
+    CircularBuffer_Init(&myPolicyRing, storage, sizeof(_RING_BUFFER_DATA_TYPE), POLICY_RING_LENGTH);
+
+    /* REJECT : all or nothing */
+    CircularBuffer_SetOverflowPolicy(&myPolicyRing, BUF_OVERFLOW_REJECT);
+    if(CircularBuffer_Enqueue(&myPolicyRing, data, 6) != 6)         failed = 1;
+    if(CircularBuffer_Enqueue(&myPolicyRing, data + 6, 4) != 0)     failed = 1;
+    if(CircularBuffer_GetCount(&myPolicyRing) != 6)                 failed = 1;
+
+    /* PARTIAL : the 2 elements which fit */
+    CircularBuffer_SetOverflowPolicy(&myPolicyRing, BUF_OVERFLOW_PARTIAL);
+    if(CircularBuffer_Enqueue(&myPolicyRing, data + 6, 4) != 2)     failed = 1;
+    if(CircularBuffer_Dequeue(&myPolicyRing, out, 2*POLICY_RING_LENGTH) != POLICY_RING_LENGTH)     failed = 1;
+    failed |= checkSequence(out, POLICY_RING_LENGTH, 0);
+
+    /* OVERWRITE : front moves past the oldest elements, also for an input longer than the buffer */
+    CircularBuffer_SetOverflowPolicy(&myPolicyRing, BUF_OVERFLOW_OVERWRITE);
+    CircularBuffer_Enqueue(&myPolicyRing, data, POLICY_RING_LENGTH);
+    if(CircularBuffer_Enqueue(&myPolicyRing, data + POLICY_RING_LENGTH, 3) != 3)       failed = 1;
+    if(!CircularBuffer_IsFull(&myPolicyRing))                                           failed = 1;
+    if(*(_RING_BUFFER_DATA_TYPE *)CircularBuffer_PeekAt(&myPolicyRing, 0) != 3)        failed = 1;
+    if(CircularBuffer_Dequeue(&myPolicyRing, out, 2*POLICY_RING_LENGTH) != POLICY_RING_LENGTH)     failed = 1;
+    failed |= checkSequence(out, POLICY_RING_LENGTH, 3);
+
+    if(CircularBuffer_Enqueue(&myPolicyRing, data, 2*POLICY_RING_LENGTH - 3) != POLICY_RING_LENGTH)     failed = 1;
+    if(CircularBuffer_Dequeue(&myPolicyRing, out, 2*POLICY_RING_LENGTH) != POLICY_RING_LENGTH)         failed = 1;
+    failed |= checkSequence(out, POLICY_RING_LENGTH, POLICY_RING_LENGTH - 3);
+
+    /* Readiness : 1 signal when 5 -> 8 crosses level 6, none for the overwrites of the full buffer */
+    event.fd = -1;
+    event.level = POLICY_EVENT_LEVEL;
+    event.fromFrame = 0;
+    event.signal = policySignal;
+    myPolicyRing.event = &event;
+    policySignalCount = 0;
+    CircularBuffer_Enqueue(&myPolicyRing, data, 5);
+    if(policySignalCount != 0)      failed = 1;
+    CircularBuffer_Enqueue(&myPolicyRing, data, 3);
+    if(policySignalCount != 1)      failed = 1;
+    CircularBuffer_Enqueue(&myPolicyRing, data, 3);
+    CircularBuffer_Enqueue(&myPolicyRing, data, 1);
+    if(policySignalCount != 1)      failed = 1;
+
+    /* Below the level again, then crossing it with an overwrite from 5 elements */
+    CircularBuffer_Dequeue(&myPolicyRing, out, 3);
+    CircularBuffer_Enqueue(&myPolicyRing, data, 2*POLICY_RING_LENGTH);
+    if(policySignalCount != 2)      failed = 1;
+    myPolicyRing.event = NULL;
+
+    return report("Overflow policies and readiness on overwrite", failed);
+}
+
+
+/*
+ * Watermark hysteresis : onHigh() once when count rises to highLevel, onLow() only after onHigh() when count falls to lowLevel.
+ * Statistics counters : the same en-queue/de-queue sequence in both index modes gives known counter values.
+ */
+#define     WATERMARK_RING_LENGTH   8
+#define     WATERMARK_HIGH_LEVEL    6
+#define     WATERMARK_LOW_LEVEL     2
+
+typedef struct {
+
+    uint32_t    highCalls;
+    uint32_t    lowCalls;
+    uint32_t    lastCount;
+
+} watermarkCounter_TypeDef;
+
+static void watermarkOnHigh(void *userData, uint32_t count)
+{
+    watermarkCounter_TypeDef *counter = userData;
+
+    counter->highCalls++;
+    counter->lastCount = count;
+}
+
+static void watermarkOnLow(void *userData, uint32_t count)
+{
+    watermarkCounter_TypeDef *counter = userData;
+
+    counter->lowCalls++;
+    counter->lastCount = count;
+}
+
+static int checkWatermark(const watermarkCounter_TypeDef *counter, uint32_t highCalls, uint32_t lowCalls, uint32_t lastCount)
+{
+    return (counter->highCalls != highCalls) || (counter->lowCalls != lowCalls) || (counter->lastCount != lastCount);
+}
+
+static int testWatermarkAndStats(void)
+{
+    circularBuffer_TypeDef              myWatermarkRing;
+    circularBufferWatermark_TypeDef     watermark;
+    watermarkCounter_TypeDef            counter = {0, 0, 0};
+    circularBufferStats_TypeDef         stats;
+    circularBufferStatsSnapshot_TypeDef snapshot;
+    _RING_BUFFER_DATA_TYPE              storage[WATERMARK_RING_LENGTH];
+    _RING_BUFFER_DATA_TYPE              data[2*WATERMARK_RING_LENGTH] = {0};
+    uint8_t                             mode;
+    int                                 failed = 0;
+
+    CircularBuffer_Init(&myWatermarkRing, storage, sizeof(_RING_BUFFER_DATA_TYPE), WATERMARK_RING_LENGTH);
+
+    watermark.highLevel = WATERMARK_LOW_LEVEL;
+    watermark.lowLevel = WATERMARK_HIGH_LEVEL;
+    if(CircularBuffer_SetWatermark(&myWatermarkRing, &watermark) != 1)      failed = 1;
+
+    watermark.highLevel = WATERMARK_HIGH_LEVEL;
+    watermark.lowLevel = WATERMARK_LOW_LEVEL;
+    watermark.onHigh = watermarkOnHigh;
+    watermark.onLow = watermarkOnLow;
+    watermark.userData = &counter;
+    if(CircularBuffer_SetWatermark(&myWatermarkRing, &watermark) != 0)      failed = 1;
+
+    CircularBuffer_Enqueue(&myWatermarkRing, data, 5);
+    failed |= checkWatermark(&counter, 0, 0, 0);
+    CircularBuffer_Enqueue(&myWatermarkRing, data, 1);
+    failed |= checkWatermark(&counter, 1, 0, 6);
+    CircularBuffer_Enqueue(&myWatermarkRing, data, 2);
+    failed |= checkWatermark(&counter, 1, 0, 6);
+    CircularBuffer_Dequeue(&myWatermarkRing, data, 3);
+    failed |= checkWatermark(&counter, 1, 0, 6);
+    CircularBuffer_Dequeue(&myWatermarkRing, data, 3);
+    failed |= checkWatermark(&counter, 1, 1, 2);
+    CircularBuffer_Enqueue(&myWatermarkRing, data, 1);
+    CircularBuffer_Dequeue(&myWatermarkRing, data, 3);
+    failed |= checkWatermark(&counter, 1, 1, 2);
+    CircularBuffer_Enqueue(&myWatermarkRing, data, 7);
+    failed |= checkWatermark(&counter, 2, 1, 7);
+
+    /* Registration at highLevel calls onHigh() before return */
+    if(CircularBuffer_SetWatermark(&myWatermarkRing, &watermark) != 0)      failed = 1;
+    failed |= checkWatermark(&counter, 3, 1, 7);
+    CircularBuffer_Flush(&myWatermarkRing);
+    failed |= checkWatermark(&counter, 3, 2, 0);
+    CircularBuffer_SetWatermark(&myWatermarkRing, NULL);
+
+    for(mode=BUF_MODE_DEFAULT; mode<=BUF_MODE_POW2; mode++)
+    {
+        if(mode == BUF_MODE_POW2)   CircularBuffer_InitPow2(&myWatermarkRing, storage, sizeof(_RING_BUFFER_DATA_TYPE), WATERMARK_RING_LENGTH);
+        else                        CircularBuffer_Init(&myWatermarkRing, storage, sizeof(_RING_BUFFER_DATA_TYPE), WATERMARK_RING_LENGTH);
+        CircularBuffer_SetStats(&myWatermarkRing, &stats);
+
+        CircularBuffer_Enqueue(&myWatermarkRing, data, 6);
+        CircularBuffer_Dequeue(&myWatermarkRing, data, 4);
+        CircularBuffer_Enqueue(&myWatermarkRing, data, 5);                 //rear wraps
+        if(CircularBuffer_Enqueue(&myWatermarkRing, data, 3) != 1)      failed = 1;     //2 elements dropped
+        if(CircularBuffer_Dequeue(&myWatermarkRing, data, 10) != 8)     failed = 1;     //underrun
+        if(CircularBuffer_Dequeue(&myWatermarkRing, data, 1) != 0)      failed = 1;     //underrun
+
+        if(CircularBuffer_GetStats(&myWatermarkRing, &snapshot) != 0)   failed = 1;
+        if((snapshot.enqueued != 12) || (snapshot.dequeued != 12))      failed = 1;
+        if((snapshot.overrun != 2) || (snapshot.underrun != 2))         failed = 1;
+        if((snapshot.wraps != 1) || (snapshot.maxFill != WATERMARK_RING_LENGTH))    failed = 1;
+    }
+    CircularBuffer_SetStats(&myWatermarkRing, NULL);
+    if(CircularBuffer_GetStats(&myWatermarkRing, &snapshot) == 0)       failed = 1;
+
+    return report("Watermark hysteresis and statistics counters", failed);
+}
+
+
+/*
+ * Random access on a wrapped buffer, in both index modes : PeekAt() counts from front, PeekAtRear() from rear, CopyLast()
+ * copies the newest elements oldest first. An index past the number of elements gives NULL, front and rear are not moved.
+ */
+#define     PEEK_RING_LENGTH        8
+
+static int testPeekAtAndCopyLast(void)
+{
+    circularBuffer_TypeDef  myPeekRing;
+    _RING_BUFFER_DATA_TYPE  storage[PEEK_RING_LENGTH];
+    _RING_BUFFER_DATA_TYPE  data[2*PEEK_RING_LENGTH];
+    _RING_BUFFER_DATA_TYPE  out[2*PEEK_RING_LENGTH];
+    _RING_BUFFER_DATA_TYPE  *element;
+    uint32_t                i;
+    uint8_t                 mode;
+    int                     failed = 0;
+
+    for(i=0; i<2*PEEK_RING_LENGTH; i++)     data[i] = i;
+
+    for(mode=BUF_MODE_DEFAULT; mode<=BUF_MODE_POW2; mode++)
+    {
+        if(mode == BUF_MODE_POW2)   CircularBuffer_InitPow2(&myPeekRing, storage, sizeof(_RING_BUFFER_DATA_TYPE), PEEK_RING_LENGTH);
+        else                        CircularBuffer_Init(&myPeekRing, storage, sizeof(_RING_BUFFER_DATA_TYPE), PEEK_RING_LENGTH);
+
+        if(CircularBuffer_PeekAt(&myPeekRing, 0) != NULL)           failed = 1;
+        if(CircularBuffer_PeekAtRear(&myPeekRing, 0) != NULL)       failed = 1;
+        if(CircularBuffer_CopyLast(&myPeekRing, out, 1) != 0)       failed = 1;
+
+        /* Elements 5..11 at index 5,6,7,0,1,2,3 */
+        CircularBuffer_Enqueue(&myPeekRing, data, 6);
+        CircularBuffer_Dequeue(&myPeekRing, out, 5);
+        CircularBuffer_Enqueue(&myPeekRing, data + 6, 6);
+
+        for(i=0; i<7; i++)
+        {
+            element = CircularBuffer_PeekAt(&myPeekRing, i);
+            if((element == NULL) || (*element != (_RING_BUFFER_DATA_TYPE)(5 + i)))     failed = 1;
+            element = CircularBuffer_PeekAtRear(&myPeekRing, i);
+            if((element == NULL) || (*element != (_RING_BUFFER_DATA_TYPE)(11 - i)))    failed = 1;
+        }
+        if(CircularBuffer_PeekAt(&myPeekRing, 7) != NULL)           failed = 1;
+        if(CircularBuffer_PeekAtRear(&myPeekRing, 7) != NULL)       failed = 1;
+        if(CircularBuffer_PeekAt(&myPeekRing, UINT32_MAX) != NULL)  failed = 1;
+
+        if(CircularBuffer_CopyLast(&myPeekRing, out, 6) != 6)       failed = 1;    //wrapped copy, 6..11
+        failed |= checkSequence(out, 6, 6);
+        if(CircularBuffer_CopyLast(&myPeekRing, out, 2*PEEK_RING_LENGTH) != 7)     failed = 1;
+        failed |= checkSequence(out, 7, 5);
+        if(CircularBuffer_GetCount(&myPeekRing) != 7)               failed = 1;
+
+        /* Full buffer : last index is valid */
+        CircularBuffer_Enqueue(&myPeekRing, data + 12, 1);
+        element = CircularBuffer_PeekAt(&myPeekRing, PEEK_RING_LENGTH - 1);
+        if((element == NULL) || (*element != 12))                   failed = 1;
+        element = CircularBuffer_PeekAtRear(&myPeekRing, PEEK_RING_LENGTH - 1);
+        if((element == NULL) || (*element != 5))                    failed = 1;
+        if(CircularBuffer_PeekAt(&myPeekRing, PEEK_RING_LENGTH) != NULL)   failed = 1;
+        if(CircularBuffer_Dequeue(&myPeekRing, out, 2*PEEK_RING_LENGTH) != PEEK_RING_LENGTH)   failed = 1;
+        failed |= checkSequence(out, PEEK_RING_LENGTH, 5);
+    }
+
+    return report("PeekAt, PeekAtRear, CopyLast on wrapped buffer", failed);
+}
+
+
+/*
+ * Float conversion : the kernel picked for this CPU (SSE2/AVX2/NEON) gives the same floats as a scalar conversion, for
+ * negative and full-scale samples, every tail length up to 3 vectors and unaligned pointers. DequeueFloat() and
+ * GetNextFrameFloat() convert the 2 sections of a wrapped region in order.
+ */
+#define     CONVERT_MAX_SAMPLES     37
+#define     CONVERT_RING_LENGTH     13
+#define     CONVERT_FRAME_SIZE      6
+#define     CONVERT_FRAME_OVERLAP   2
+
+/* Sample k of a source type : full scale values first, then pseudo random values of both signs */
+static int32_t convertSample(uint8_t sourceType, uint32_t k)
+{
+    static const int32_t fullScale[] = {32767, 8388607, 2147483647};
+    int32_t              max = fullScale[sourceType];
+    uint32_t             bits = (sourceType == BUF_CONVERT_INT16) ? 16 : ((sourceType == BUF_CONVERT_INT24) ? 24 : 32);
+    uint32_t             v = k*2654435761u + 12345u;
+
+    switch(k)
+    {
+        case 0  : return -max - 1;
+        case 1  : return max;
+        case 2  : return -1;
+        case 3  : return 0;
+        default : return (bits == 32) ? (int32_t)v : (int32_t)(v << (32 - bits)) >> (32 - bits);
+    }
+}
+
+/* Store samples first..first+n-1 in the packed little-endian layout of a source type */
+static void convertPack(uint8_t *dst, uint8_t sourceType, uint32_t first, uint32_t n)
+{
+    uint32_t i;
+    int32_t  v;
+    int16_t  v16;
+
+    for(i=0; i<n; i++)
+    {
+        v = convertSample(sourceType, first + i);
+        switch(sourceType)
+        {
+            case BUF_CONVERT_INT16 : v16 = (int16_t)v; memcpy(dst + 2*i, &v16, sizeof(v16)); break;
+            case BUF_CONVERT_INT24 : dst[3*i] = (uint8_t)v; dst[3*i + 1] = (uint8_t)(v >> 8); dst[3*i + 2] = (uint8_t)(v >> 16); break;
+            default                : memcpy(dst + 4*i, &v, sizeof(v)); break;
+        }
+    }
+}
+
+/* Compare with the scalar conversion of samples first..first+n-1 */
+static int checkFloat(const float *data, uint8_t sourceType, float scale, uint32_t first, uint32_t n)
+{
+    uint32_t i;
+
+    for(i=0; i<n; i++)
+    {
+        if(data[i] != (float)convertSample(sourceType, first + i)*scale)    return 1;
+    }
+    return 0;
+}
+
+static int testConvertFloat(void)
+{
+    static const float      scale[] = {BUF_CONVERT_SCALE_INT16, BUF_CONVERT_SCALE_INT24, BUF_CONVERT_SCALE_INT32};
+    static const int8_t     sourceSize[] = {2, 3, 4};
+    circularBuffer_TypeDef  myConvertRing;
+    dspFrame_TypeDef        frame;
+    uint8_t                 storage[CONVERT_RING_LENGTH*4];
+    uint8_t                 src[(CONVERT_MAX_SAMPLES + 1)*4];
+    uint8_t                 frameArray[CONVERT_FRAME_SIZE*2];
+    float                   dst[CONVERT_MAX_SAMPLES + 1];
+    uint32_t                n, pushed, frames;
+    uint8_t                 type;
+    int                     failed = 0;
+
+    /* Dispatched kernel, src and dst shifted by 1 element so they are not vector aligned */
+    for(type=BUF_CONVERT_INT16; type<=BUF_CONVERT_INT32; type++)
+    {
+        convertPack(src + sourceSize[type], type, 0, CONVERT_MAX_SAMPLES);
+        for(n=0; n<=CONVERT_MAX_SAMPLES; n++)
+        {
+            CircularBuffer_ConvertToFloat(dst + 1, src + sourceSize[type], n, type, scale[type]);
+            failed |= checkFloat(dst + 1, type, scale[type], 0, n);
+        }
+    }
+
+    /* DequeueFloat() of 11 samples, 8 before the wrap and 3 after it */
+    for(type=BUF_CONVERT_INT16; type<=BUF_CONVERT_INT32; type++)
+    {
+        CircularBuffer_Init(&myConvertRing, storage, sourceSize[type], CONVERT_RING_LENGTH);
+        if(CircularBuffer_DequeueFloat(&myConvertRing, dst, 1, (type + 1)%3, scale[type]) != 0)   failed = 1;
+
+        convertPack(src, type, 0, 9);
+        CircularBuffer_Enqueue(&myConvertRing, src, 9);
+        if(CircularBuffer_DequeueFloat(&myConvertRing, dst, 5, type, scale[type]) != 5)   failed = 1;
+        failed |= checkFloat(dst, type, scale[type], 0, 5);
+
+        convertPack(src, type, 9, 8);
+        CircularBuffer_Enqueue(&myConvertRing, src, 8);
+        if(CircularBuffer_DequeueFloat(&myConvertRing, dst, 11, type, scale[type]) != 11) failed = 1;
+        failed |= checkFloat(dst, type, scale[type], 5, 11);
+        if(CircularBuffer_GetCount(&myConvertRing) != 1)    failed = 1;
+    }
+
+    /* GetNextFrameFloat() of int16 frames with overlap, fed 3 samples at a time so frames wrap at different points */
+    CircularBuffer_Init(&myConvertRing, storage, sizeof(int16_t), CONVERT_RING_LENGTH);
+    DSP_frameExtraction_Init(&frame, frameArray, sizeof(int16_t), CONVERT_FRAME_SIZE, CONVERT_FRAME_OVERLAP);
+    for(pushed=0, frames=0; pushed<30; pushed+=3)
+    {
+        convertPack(src, BUF_CONVERT_INT16, pushed, 3);
+        if(CircularBuffer_Enqueue(&myConvertRing, src, 3) != 3)     failed = 1;
+        while(DSP_frameExtraction_GetNextFrameFloat(&myConvertRing, &frame, dst, BUF_CONVERT_INT16, scale[BUF_CONVERT_INT16]) == FRAME_IS_READY)
+        {
+            failed |= checkFloat(dst, BUF_CONVERT_INT16, scale[BUF_CONVERT_INT16],
+                                 frames*(CONVERT_FRAME_SIZE - CONVERT_FRAME_OVERLAP), CONVERT_FRAME_SIZE);
+            frames++;
+        }
+    }
+    if(frames != (30 - CONVERT_FRAME_SIZE)/(CONVERT_FRAME_SIZE - CONVERT_FRAME_OVERLAP) + 1)     failed = 1;
+    if(DSP_frameExtraction_GetNextFrameFloat(&myConvertRing, &frame, dst, BUF_CONVERT_INT32, 1.0f) != FRAME_ERROR)  failed = 1;
+
+    return report("Float conversion kernels, tails and wrap split", failed);
+}
+
+
+/*
+ * Resize of the default buffer, in both index modes : wrapped elements are moved in order (BUF_MODE_POW2 also wraps them
+ * again at the new size). A new size below the number of elements (or not a power of two in BUF_MODE_POW2) is refused and
+ * leaves the buffer as it was. Mirrored, allocated and persistent buffers are refused, their storage is not from the caller.
+ */
+#define     RESIZE_RING_LENGTH      8
+#define     RESIZE_GROW_LENGTH      16
+#define     RESIZE_MAPPED_LENGTH    1024
+
+static int testResize(void)
+{
+    circularBuffer_TypeDef          myResizeRing;
+    circularBufferPersist_TypeDef   persist;
+    _RING_BUFFER_DATA_TYPE          storage[RESIZE_RING_LENGTH];
+    _RING_BUFFER_DATA_TYPE          grown[RESIZE_GROW_LENGTH];
+    _RING_BUFFER_DATA_TYPE          shrunk[RESIZE_RING_LENGTH];
+    _RING_BUFFER_DATA_TYPE          data[2*RESIZE_GROW_LENGTH];
+    _RING_BUFFER_DATA_TYPE          out[2*RESIZE_GROW_LENGTH];
+    char                            path[] = "/tmp/testbench_circularBufferXXXXXX";
+    int                             fd;
+    int32_t                         i;
+    uint8_t                         mode;
+    int                             failed = 0;
+
+    for(i=0; i<2*RESIZE_GROW_LENGTH; i++)   data[i] = i;
+
+    for(mode=BUF_MODE_DEFAULT; mode<=BUF_MODE_POW2; mode++)
+    {
+        if(mode == BUF_MODE_POW2)   CircularBuffer_InitPow2(&myResizeRing, storage, sizeof(_RING_BUFFER_DATA_TYPE), RESIZE_RING_LENGTH);
+        else                        CircularBuffer_Init(&myResizeRing, storage, sizeof(_RING_BUFFER_DATA_TYPE), RESIZE_RING_LENGTH);
+
+        /* Elements 4..10 at index 4..7,0..2 */
+        CircularBuffer_Enqueue(&myResizeRing, data, 6);
+        CircularBuffer_Dequeue(&myResizeRing, out, 4);
+        CircularBuffer_Enqueue(&myResizeRing, data + 6, 5);
+
+        /* Refused : below the number of elements, not a power of two, empty size */
+        if(CircularBuffer_Resize(&myResizeRing, shrunk, 6) != 1)                    failed = 1;
+        if(CircularBuffer_Resize(&myResizeRing, shrunk, 0) != 1)                    failed = 1;
+        if((mode == BUF_MODE_POW2) && (CircularBuffer_Resize(&myResizeRing, grown, 12) != 1))      failed = 1;
+        if((myResizeRing.buf != storage) || (CircularBuffer_GetCount(&myResizeRing) != 7))     failed = 1;
+
+        /* Grow, then fill the new space */
+        if(CircularBuffer_Resize(&myResizeRing, grown, RESIZE_GROW_LENGTH) != 0)   failed = 1;
+        if(CircularBuffer_GetCount(&myResizeRing) != 7)                             failed = 1;
+        if(CircularBuffer_Enqueue(&myResizeRing, data + 11, RESIZE_GROW_LENGTH) != RESIZE_GROW_LENGTH - 7)     failed = 1;
+        if(!CircularBuffer_IsFull(&myResizeRing))                                   failed = 1;
+        if(CircularBuffer_Dequeue(&myResizeRing, out, 10) != 10)                    failed = 1;
+        failed |= checkSequence(out, 10, 4);
+
+        /* Shrink a wrapped buffer (elements 14..21) to its number of elements */
+        CircularBuffer_Enqueue(&myResizeRing, data + 20, 2);
+        if(CircularBuffer_Resize(&myResizeRing, shrunk, RESIZE_RING_LENGTH) != 0)  failed = 1;
+        if(!CircularBuffer_IsFull(&myResizeRing))                                   failed = 1;
+        if(CircularBuffer_Dequeue(&myResizeRing, out, 3) != 3)                      failed = 1;
+        if(CircularBuffer_Enqueue(&myResizeRing, data + 22, 6) != 3)                failed = 1;
+        if(CircularBuffer_Dequeue(&myResizeRing, out + 3, RESIZE_GROW_LENGTH) != RESIZE_RING_LENGTH)   failed = 1;
+        failed |= checkSequence(out, RESIZE_RING_LENGTH + 3, 14);
+    }
+
+    /* BUF_MODE_POW2 keeps fPos : elements 5..10 at index 5..10 of 16 move to index 5..7,0..2 of 8 */
+    CircularBuffer_InitPow2(&myResizeRing, grown, sizeof(_RING_BUFFER_DATA_TYPE), RESIZE_GROW_LENGTH);
+    CircularBuffer_Enqueue(&myResizeRing, data, 11);
+    CircularBuffer_Dequeue(&myResizeRing, out, 5);
+    if(CircularBuffer_Resize(&myResizeRing, shrunk, RESIZE_RING_LENGTH) != 0)      failed = 1;
+    if((shrunk[0] != 8) || (shrunk[RESIZE_RING_LENGTH - 1] != 7))                 failed = 1;
+    if(CircularBuffer_Dequeue(&myResizeRing, out, RESIZE_GROW_LENGTH) != 6)        failed = 1;
+    failed |= checkSequence(out, 6, 5);
+
+    /* Buffers which do not own a caller array */
+    if(CircularBuffer_Create(&myResizeRing, sizeof(_RING_BUFFER_DATA_TYPE), RESIZE_MAPPED_LENGTH, BUF_ALLOC_PAGE_4K, BUF_ALLOC_NODE_ANY, 0) != 0)
+    {
+        failed = 1;
+    }
+    else
+    {
+        if(CircularBuffer_Resize(&myResizeRing, grown, RESIZE_GROW_LENGTH) != 1)   failed = 1;
+        CircularBuffer_Destroy(&myResizeRing);
+    }
+
+    if(CircularBuffer_InitMirror(&myResizeRing, sizeof(_RING_BUFFER_DATA_TYPE), RESIZE_MAPPED_LENGTH) != 0)
+    {
+        failed = 1;
+    }
+    else
+    {
+        if(CircularBuffer_Resize(&myResizeRing, grown, RESIZE_GROW_LENGTH) != 1)   failed = 1;
+        CircularBuffer_DeInitMirror(&myResizeRing);
+    }
+
+    fd = mkstemp(path);
+    if((fd < 0) || (close(fd) != 0) ||
+       (CircularBuffer_OpenPersistent(&myResizeRing, &persist, path, sizeof(_RING_BUFFER_DATA_TYPE), RESIZE_RING_LENGTH) != 0))
+    {
+        failed = 1;
+    }
+    else
+    {
+        if(CircularBuffer_Resize(&myResizeRing, grown, RESIZE_GROW_LENGTH) != 1)   failed = 1;
+        CircularBuffer_ClosePersistent(&myResizeRing, &persist);
+    }
+    if(fd >= 0)     unlink(path);
+
+    return report("Resize of default buffer, wrap and refusals", failed);
+}
+
+
+/*
+ * SPSC shrink with a parked producer : the producer waits for more free space than the buffer has after the resize.
+ * It must be woken by CircularBufferSPSC_Resize(), then wait for the new size only.
+ */
+#define     SPSC_RING_LENGTH        64
+#define     SPSC_SHRINK_LENGTH      16
+
+static circularBufferSPSC_TypeDef   mySpscRing;
+static _RING_BUFFER_DATA_TYPE       spscStorage[SPSC_RING_LENGTH];
+static _RING_BUFFER_DATA_TYPE       spscShrinkStorage[SPSC_SHRINK_LENGTH];
+static _Atomic int                  spscProducerDone;
+
+static void *spscShrinkProducer(void *arg)
+{
+    (void)arg;
+    CircularBufferSPSC_WaitForSpace(&mySpscRing, SPSC_RING_LENGTH - 4, -1);
+    atomic_store(&spscProducerDone, 1);
+    return NULL;
+}
+
+static int testSpscShrinkWithParkedProducer(void)
+{
+    _RING_BUFFER_DATA_TYPE  data[SPSC_RING_LENGTH];
+    pthread_t               producer;
+    int32_t                 i;
+    int                     failed = 0;
+
+    for(i=0; i<SPSC_RING_LENGTH; i++)   data[i] = i;
+    CircularBufferSPSC_Init(&mySpscRing, spscStorage, sizeof(_RING_BUFFER_DATA_TYPE), SPSC_RING_LENGTH);
+    CircularBufferSPSC_Enqueue(&mySpscRing, data, 10);
+
+    atomic_store(&spscProducerDone, 0);
+    pthread_create(&producer, NULL, spscShrinkProducer, NULL);
+    while(atomic_load(&mySpscRing.spaceWaitLevel) == 0)     sleepMs(1);
+
+    /* Level 60 is not reachable in 16 elements */
+    if(CircularBufferSPSC_Resize(&mySpscRing, spscShrinkStorage, SPSC_SHRINK_LENGTH) != 0)      failed = 1;
+    if(CircularBufferSPSC_Dequeue(&mySpscRing, data, SPSC_RING_LENGTH) != 10)                   failed = 1;
+    for(i=0; i<10; i++)
+    {
+        if(data[i] != i)    failed = 1;
+    }
+
+    if(!waitFlag(&spscProducerDone))
+    {
+        /* Producer is lost, do not join it */
+        return report("SPSC shrink wakes parked producer", 1);
+    }
+    pthread_join(producer, NULL);
+    return report("SPSC shrink wakes parked producer", failed);
+}
+
+
+/*
+ * SPSC blocking waits on a full/empty buffer : producer with BUF_OVERFLOW_BLOCK parks while the buffer is full,
+ * consumer parks in CircularBufferSPSC_WaitForData() while it is empty. Every element must arrive in order, no wake up lost.
+ */
+#define     SPSC_BLOCK_ELEMENTS     100000
+#define     SPSC_BLOCK_SIZE         48
+
+static _Atomic int                  spscBlockDone;
+
+static void *spscBlockProducer(void *arg)
+{
+    _RING_BUFFER_DATA_TYPE  data[SPSC_BLOCK_SIZE];
+    int32_t                 next, i;
+
+    (void)arg;
+    for(next=0; next<SPSC_BLOCK_ELEMENTS; next+=SPSC_BLOCK_SIZE)
+    {
+        for(i=0; i<SPSC_BLOCK_SIZE; i++)    data[i] = next + i;
+        CircularBufferSPSC_Enqueue(&mySpscRing, data, SPSC_BLOCK_SIZE);
+    }
+    return NULL;
+}
+
+static void *spscBlockConsumer(void *arg)
+{
+    _RING_BUFFER_DATA_TYPE  data[SPSC_RING_LENGTH];
+    int32_t                 want = 0;
+    uint32_t                doneSize, i;
+    int                     *failed = (int *)arg;
+    int32_t                 total = (SPSC_BLOCK_ELEMENTS + SPSC_BLOCK_SIZE - 1)/SPSC_BLOCK_SIZE*SPSC_BLOCK_SIZE;
+
+    while(want < total)
+    {
+        /* Wait for a whole block (or the rest of data), more than the free space the producer is left with */
+        CircularBufferSPSC_WaitForData(&mySpscRing, (total - want < SPSC_BLOCK_SIZE) ? (uint32_t)(total - want) : SPSC_BLOCK_SIZE, -1);
+        doneSize = CircularBufferSPSC_Dequeue(&mySpscRing, data, SPSC_RING_LENGTH);
+        for(i=0; i<doneSize; i++)
+        {
+            if(data[i] != want++)   *failed = 1;
+        }
+    }
+    atomic_store(&spscBlockDone, 1);
+    return NULL;
+}
+
+static int testSpscBlockingFullAndEmpty(void)
+{
+    pthread_t   producer;
+    pthread_t   consumer;
+    int         failed = 0;
+
+    CircularBufferSPSC_Init(&mySpscRing, spscStorage, sizeof(_RING_BUFFER_DATA_TYPE), SPSC_RING_LENGTH);
+    CircularBufferSPSC_SetOverflowPolicy(&mySpscRing, BUF_OVERFLOW_BLOCK);
+
+    /* Empty buffer : a wait with timeout returns 0 */
+    if(CircularBufferSPSC_WaitForData(&mySpscRing, 1, 10) != 0)     failed = 1;
+
+    atomic_store(&spscBlockDone, 0);
+    pthread_create(&consumer, NULL, spscBlockConsumer, &failed);
+    pthread_create(&producer, NULL, spscBlockProducer, NULL);
+
+    if(!waitFlag(&spscBlockDone))
+    {
+        return report("SPSC blocking waits on full/empty buffer", 1);
+    }
+    pthread_join(producer, NULL);
+    pthread_join(consumer, NULL);
+    if(!CircularBufferSPSC_IsEmpty(&mySpscRing))        failed = 1;
+    return report("SPSC blocking waits on full/empty buffer", failed);
+}
+
+/*
+ * Record commit smaller than the reservation at the wrap point : the reservation only fits after a skip marker,
+ * the committed size would fit before the wrap point. The record must stay where the payload was written.
+ */
+#define     RECORD_RING_LENGTH      64
+
+static _Alignas(CIRCULAR_BUFFER_RECORD_ALIGN) uint8_t   recordStorage[RECORD_RING_LENGTH];
+
+static int testRecordShortCommitAtWrap(void)
+{
+    circularBuffer_TypeDef  myRecordRing;
+    uint8_t                 data[RECORD_RING_LENGTH];
+    uint8_t                 *payload;
+    const uint8_t           *record;
+    uint32_t                recordSize;
+    uint32_t                i;
+    int                     failed = 0;
+
+    for(i=0; i<RECORD_RING_LENGTH; i++)     data[i] = (uint8_t)i;
+    CircularBuffer_InitRecord(&myRecordRing, recordStorage, RECORD_RING_LENGTH);
+
+    /* 2 records of 24 bytes (8 + 16), then free the first one : 16 bytes free before the wrap point, 24 after */
+    CircularBuffer_EnqueueRecord(&myRecordRing, data, 16);
+    CircularBuffer_EnqueueRecord(&myRecordRing, data, 16);
+    CircularBuffer_DequeueRecord(&myRecordRing, data, RECORD_RING_LENGTH);
+
+    /* 16-byte payload needs 24 bytes : after the wrap point. 4-byte commit needs 16 bytes : would fit before it */
+    payload = (uint8_t *)CircularBuffer_ReserveRecord(&myRecordRing, 16);
+    if(payload != recordStorage + CIRCULAR_BUFFER_RECORD_ALIGN)     failed = 1;
+    if(payload != NULL)
+    {
+        payload[0] = 0xA5;
+        payload[1] = 0x5A;
+        payload[2] = 0xC3;
+        payload[3] = 0x3C;
+        if(CircularBuffer_CommitRecord(&myRecordRing, 4) != 4)      failed = 1;
+    }
+
+    /* Oldest is the 2nd record, then the committed one */
+    CircularBuffer_ConsumeRecord(&myRecordRing);
+    record = (const uint8_t *)CircularBuffer_PeekRecord(&myRecordRing, &recordSize);
+    if((record != payload) || (recordSize != 4))                    failed = 1;
+    else if((record[0] != 0xA5) || (record[1] != 0x5A) || (record[2] != 0xC3) || (record[3] != 0x3C))     failed = 1;
+
+    CircularBuffer_ConsumeRecord(&myRecordRing);
+    if(!CircularBuffer_IsEmpty(&myRecordRing))                      failed = 1;
+
+    /* Commit larger than the reservation is refused */
+    payload = (uint8_t *)CircularBuffer_ReserveRecord(&myRecordRing, 8);
+    if((payload == NULL) || (CircularBuffer_CommitRecord(&myRecordRing, 16) != 0))     failed = 1;
+
+    return report("Record short commit at wrap point", failed);
+}
+
+
+/*
+ * MPMC contention on a small buffer : producers and consumers retry their CAS while the buffer is often full or empty,
+ * so requests are limited to the free space/data on many attempts. No element may be lost, duplicated or reordered.
+ */
+#define     MPMC_RING_LENGTH        64
+#define     MPMC_PRODUCERS          3
+#define     MPMC_CONSUMERS          2
+#define     MPMC_ELEMENTS           200000      //per producer
+#define     MPMC_BLOCK              24
+
+static circularBufferMPMC_TypeDef   myMpmcRing;
+static _RING_BUFFER_DATA_TYPE       mpmcStorage[MPMC_RING_LENGTH];
+static _Atomic uint64_t             mpmcReceived;
+static _Atomic uint64_t             mpmcSum[MPMC_PRODUCERS];
+static _Atomic int                  mpmcOrderError;
+
+static void *mpmcProducer(void *arg)
+{
+    _RING_BUFFER_DATA_TYPE  data[MPMC_BLOCK];
+    int32_t                 id = (int32_t)(intptr_t)arg;
+    int32_t                 next = 0;
+    uint32_t                doneSize, i;
+
+    while(next < MPMC_ELEMENTS)
+    {
+        for(i=0; i<MPMC_BLOCK; i++)     data[i] = (id << 24) | (next + (int32_t)i);
+        doneSize = CircularBufferMPMC_Enqueue(&myMpmcRing, data, (MPMC_ELEMENTS - next < MPMC_BLOCK) ? (uint32_t)(MPMC_ELEMENTS - next) : MPMC_BLOCK);
+        next += (int32_t)doneSize;
+        if(doneSize == 0)       sched_yield();
+    }
+    return NULL;
+}
+
+static void *mpmcConsumer(void *arg)
+{
+    _RING_BUFFER_DATA_TYPE  data[MPMC_BLOCK];
+    int32_t                 last[MPMC_PRODUCERS];
+    uint32_t                doneSize, i;
+    int32_t                 id, seq;
+
+    (void)arg;
+    for(i=0; i<MPMC_PRODUCERS; i++)     last[i] = -1;
+
+    while(atomic_load(&mpmcReceived) < (uint64_t)MPMC_PRODUCERS*MPMC_ELEMENTS)
+    {
+        doneSize = CircularBufferMPMC_Dequeue(&myMpmcRing, data, MPMC_BLOCK);
+        for(i=0; i<doneSize; i++)
+        {
+            id  = data[i] >> 24;
+            seq = data[i] & 0xFFFFFF;
+            /* Each consumer sees the elements of a producer in order */
+            if((id < 0) || (id >= MPMC_PRODUCERS) || (seq <= last[id]))     atomic_store(&mpmcOrderError, 1);
+            else
+            {
+                last[id] = seq;
+                atomic_fetch_add(&mpmcSum[id], (uint64_t)seq);
+            }
+        }
+        atomic_fetch_add(&mpmcReceived, doneSize);
+        if(doneSize == 0)       sched_yield();
+    }
+    return NULL;
+}
+
+static int testMpmcContention(void)
+{
+    pthread_t   producer[MPMC_PRODUCERS];
+    pthread_t   consumer[MPMC_CONSUMERS];
+    intptr_t    i;
+    int         failed = 0;
+
+    CircularBufferMPMC_Init(&myMpmcRing, mpmcStorage, sizeof(_RING_BUFFER_DATA_TYPE), MPMC_RING_LENGTH);
+    atomic_store(&mpmcReceived, 0);
+    atomic_store(&mpmcOrderError, 0);
+    for(i=0; i<MPMC_PRODUCERS; i++)     atomic_store(&mpmcSum[i], 0);
+
+    for(i=0; i<MPMC_CONSUMERS; i++)     pthread_create(&consumer[i], NULL, mpmcConsumer, NULL);
+    for(i=0; i<MPMC_PRODUCERS; i++)     pthread_create(&producer[i], NULL, mpmcProducer, (void *)i);
+    for(i=0; i<MPMC_PRODUCERS; i++)     pthread_join(producer[i], NULL);
+    for(i=0; i<MPMC_CONSUMERS; i++)     pthread_join(consumer[i], NULL);
+
+    if(atomic_load(&mpmcReceived) != (uint64_t)MPMC_PRODUCERS*MPMC_ELEMENTS)       failed = 1;
+    if(atomic_load(&mpmcOrderError))                                                failed = 1;
+    for(i=0; i<MPMC_PRODUCERS; i++)
+    {
+        /* Each sequence number exactly once : 0 + 1 + ... + (MPMC_ELEMENTS - 1) */
+        if(atomic_load(&mpmcSum[i]) != (uint64_t)MPMC_ELEMENTS*(MPMC_ELEMENTS - 1)/2)     failed = 1;
+    }
+    if(!CircularBufferMPMC_IsEmpty(&myMpmcRing))                                   failed = 1;
+
+    return report("MPMC contention on full/empty buffer", failed);
+}
+
+
+/*
+ * Broadcast buffer full of consumers, and a slow consumer at the wrap point : the id -1 of a failed AddConsumer()
+ * must be refused, the producer must stop at the slowest cursor and each consumer must read the wrapped data in order.
+ */
+#define     BROADCAST_RING_LENGTH   16
+
+static circularBufferBroadcast_TypeDef  myBroadcastRing;
+static _RING_BUFFER_DATA_TYPE           broadcastStorage[BROADCAST_RING_LENGTH];
+
+static int testBroadcastFullAndWrap(void)
+{
+    _RING_BUFFER_DATA_TYPE      data[BROADCAST_RING_LENGTH];
+    circularBufferSpan_TypeDef  span[2];
+    int8_t                      id[CIRCULAR_BUFFER_BROADCAST_MAX_CONSUMERS];
+    int8_t                      extraId;
+    int32_t                     i;
+    int                         failed = 0;
+
+    for(i=0; i<BROADCAST_RING_LENGTH; i++)      data[i] = i;
+    CircularBufferBroadcast_Init(&myBroadcastRing, broadcastStorage, sizeof(_RING_BUFFER_DATA_TYPE), BROADCAST_RING_LENGTH);
+
+    /* All cursors taken */
+    for(i=0; i<CIRCULAR_BUFFER_BROADCAST_MAX_CONSUMERS; i++)
+    {
+        id[i] = CircularBufferBroadcast_AddConsumer(&myBroadcastRing);
+        if(id[i] < 0)       failed = 1;
+    }
+    extraId = CircularBufferBroadcast_AddConsumer(&myBroadcastRing);
+    if(extraId != -1)       failed = 1;
+
+    /* Invalid ids read nothing and change nothing */
+    CircularBufferBroadcast_Enqueue(&myBroadcastRing, data, 10);
+    if(CircularBufferBroadcast_GetCount(&myBroadcastRing, extraId) != 0)                    failed = 1;
+    if(CircularBufferBroadcast_Peek(&myBroadcastRing, extraId, span) != 0)                  failed = 1;
+    if((span[0].size != 0) || (span[1].size != 0))                                          failed = 1;
+    CircularBufferBroadcast_Consume(&myBroadcastRing, extraId, 10);
+    CircularBufferBroadcast_RemoveConsumer(&myBroadcastRing, extraId);
+    CircularBufferBroadcast_Consume(&myBroadcastRing, CIRCULAR_BUFFER_BROADCAST_MAX_CONSUMERS, 10);
+
+    /* Every consumer but the last one reads 10, the slowest cursor keeps the buffer 10 elements full */
+    for(i=0; i<CIRCULAR_BUFFER_BROADCAST_MAX_CONSUMERS - 1; i++)    CircularBufferBroadcast_Consume(&myBroadcastRing, id[i], 10);
+    if(CircularBufferBroadcast_Enqueue(&myBroadcastRing, data + 10, BROADCAST_RING_LENGTH) != BROADCAST_RING_LENGTH - 10)      failed = 1;
+
+    /* Slowest consumer reads its 16 elements across the wrap point */
+    if(CircularBufferBroadcast_Peek(&myBroadcastRing, id[CIRCULAR_BUFFER_BROADCAST_MAX_CONSUMERS - 1], span) != BROADCAST_RING_LENGTH)   failed = 1;
+    if((span[0].size != BROADCAST_RING_LENGTH) || (span[1].size != 0))                     failed = 1;
+    for(i=0; i<BROADCAST_RING_LENGTH; i++)
+    {
+        if(((_RING_BUFFER_DATA_TYPE *)span[0].data)[i] != i)    failed = 1;
+    }
+    CircularBufferBroadcast_Consume(&myBroadcastRing, id[CIRCULAR_BUFFER_BROADCAST_MAX_CONSUMERS - 1], BROADCAST_RING_LENGTH);
+
+    /* Faster consumers see the 6 new elements only */
+    if(CircularBufferBroadcast_Peek(&myBroadcastRing, id[0], span) != 6)                    failed = 1;
+    if((span[0].size != 6) || (((_RING_BUFFER_DATA_TYPE *)span[0].data)[0] != 10))          failed = 1;
+
+    /* Region across the end of buffer : 4 elements to move rear off index 0, then 14 elements split as 12 + 2 */
+    for(i=0; i<CIRCULAR_BUFFER_BROADCAST_MAX_CONSUMERS; i++)    CircularBufferBroadcast_Consume(&myBroadcastRing, id[i], BROADCAST_RING_LENGTH);
+    CircularBufferBroadcast_Enqueue(&myBroadcastRing, data, 4);
+    for(i=0; i<CIRCULAR_BUFFER_BROADCAST_MAX_CONSUMERS; i++)    CircularBufferBroadcast_Consume(&myBroadcastRing, id[i], 4);
+    if(CircularBufferBroadcast_Enqueue(&myBroadcastRing, data, 14) != 14)                  failed = 1;
+    if(CircularBufferBroadcast_Peek(&myBroadcastRing, id[0], span) != 14)                   failed = 1;
+    if((span[0].size != 12) || (span[1].size != 2))                                         failed = 1;
+    else if((((_RING_BUFFER_DATA_TYPE *)span[0].data)[11] != 11) || (((_RING_BUFFER_DATA_TYPE *)span[1].data)[1] != 13))    failed = 1;
+
+    return report("Broadcast full cursors and wrap", failed);
+}
+
+
+/*
+ * Persistent buffer after a crash of the process : the writer overwrites the buffer more than once after its only sync,
+ * then exits without closing. Reopen and replay must give the newest bufferSize elements in order.
+ */
+#define     PERSIST_RING_LENGTH     16
+#define     PERSIST_ELEMENTS        (2*PERSIST_RING_LENGTH + 5)
+
+static int testPersistCrashAfterWrap(void)
+{
+    circularBuffer_TypeDef          myPersistRing;
+    circularBufferPersist_TypeDef   persist;
+    _RING_BUFFER_DATA_TYPE          data[PERSIST_ELEMENTS];
+    char                            path[] = "/tmp/testbench_circularBufferXXXXXX";
+    pid_t                           writer;
+    int                             status;
+    int                             fd;
+    int32_t                         i;
+    int                             failed = 0;
+
+    for(i=0; i<PERSIST_ELEMENTS; i++)   data[i] = i;
+    fd = mkstemp(path);
+    if(fd < 0)      return report("Persistent buffer reopen after crash past wrap", 1);
+    close(fd);
+
+    writer = fork();
+    if(writer == 0)
+    {
+        if(CircularBuffer_OpenPersistent(&myPersistRing, &persist, path, sizeof(_RING_BUFFER_DATA_TYPE), PERSIST_RING_LENGTH) != 0)     _exit(1);
+        CircularBuffer_SetOverflowPolicy(&myPersistRing, BUF_OVERFLOW_OVERWRITE);
+        CircularBuffer_Enqueue(&myPersistRing, data, 5);
+        CircularBuffer_SyncPersistent(&myPersistRing, &persist, BUF_PERSIST_PROCESS);
+        for(i=5; i<PERSIST_ELEMENTS; i++)   CircularBuffer_Enqueue(&myPersistRing, &data[i], 1);
+        _exit(0);       //no sync, no close
+    }
+    if((writer < 0) || (waitpid(writer, &status, 0) != writer) || !WIFEXITED(status) || (WEXITSTATUS(status) != 0))
+    {
+        unlink(path);
+        return report("Persistent buffer reopen after crash past wrap", 1);
+    }
+
+    if(CircularBuffer_OpenPersistent(&myPersistRing, &persist, path, sizeof(_RING_BUFFER_DATA_TYPE), PERSIST_RING_LENGTH) != 0)
+    {
+        unlink(path);
+        return report("Persistent buffer reopen after crash past wrap", 1);
+    }
+
+    /* Reopen : the newest bufferSize elements are still queued */
+    if(CircularBuffer_GetCount(&myPersistRing) != PERSIST_RING_LENGTH)     failed = 1;
+    if(CircularBuffer_ReplayPersistent(&myPersistRing) != PERSIST_RING_LENGTH)     failed = 1;
+    if(CircularBuffer_Dequeue(&myPersistRing, data, PERSIST_ELEMENTS) != PERSIST_RING_LENGTH)    failed = 1;
+    for(i=0; i<PERSIST_RING_LENGTH; i++)
+    {
+        if(data[i] != PERSIST_ELEMENTS - PERSIST_RING_LENGTH + i)     failed = 1;
+    }
+
+    CircularBuffer_ClosePersistent(&myPersistRing, &persist);
+    unlink(path);
+    return report("Persistent buffer reopen after crash past wrap", failed);
+}
+
+
+/*
+ * Shared-memory buffer with a misbehaving peer : the header is writable by the other process. A shrunk bufferSize must be
+ * ignored, and an index out of range (front after rear, or rear too far ahead) must give 0 instead of an access outside the data.
+ */
+#define     SHM_RING_LENGTH         16
+
+static int testShmPeerIndexOutOfRange(void)
+{
+    circularBufferShm_TypeDef   producer;
+    circularBufferShm_TypeDef   consumer;
+    circularBufferSpan_TypeDef  span[2];
+    _RING_BUFFER_DATA_TYPE      data[SHM_RING_LENGTH];
+    int32_t                     i;
+    int                         failed = 0;
+
+    for(i=0; i<SHM_RING_LENGTH; i++)    data[i] = i;
+    if((CircularBufferShm_Create(&producer, NULL, sizeof(_RING_BUFFER_DATA_TYPE), SHM_RING_LENGTH) != 0) ||
+       (CircularBufferShm_AttachFd(&consumer, dup(producer.fd)) != 0))
+    {
+        return report("Shared-memory peer index out of range", 1);
+    }
+
+    /* Geometry is kept from attach time */
+    producer.header->bufferSize = 2;
+    if(CircularBufferShm_Enqueue(&producer, data, 10) != 10)                failed = 1;
+    if(CircularBufferShm_Peek(&consumer, span, SHM_RING_LENGTH) != 10)      failed = 1;
+    if((span[0].size != 10) || (((_RING_BUFFER_DATA_TYPE *)span[0].data)[9] != 9))     failed = 1;
+
+    /* Consumer publishes front after rear : no free space (the request does not fit the cached front, so f is reloaded) */
+    atomic_store(&producer.header->f, atomic_load(&producer.header->r) + 5);
+    if(CircularBufferShm_Enqueue(&producer, data, SHM_RING_LENGTH) != 0)    failed = 1;
+    if(CircularBufferShm_GetCount(&producer) != 0)                          failed = 1;
+
+    /* Producer publishes rear more than bufferSize ahead : no data */
+    atomic_store(&producer.header->f, 0);
+    atomic_store(&producer.header->r, 3*SHM_RING_LENGTH);
+    if(CircularBufferShm_Peek(&consumer, span, 3*SHM_RING_LENGTH) != 0)     failed = 1;
+    if((span[0].size != 0) || (span[1].size != 0))                          failed = 1;
+    if(CircularBufferShm_Consume(&consumer, 3*SHM_RING_LENGTH) != 0)        failed = 1;
+
+    CircularBufferShm_Detach(&consumer);
+    CircularBufferShm_Detach(&producer);
+    return report("Shared-memory peer index out of range", failed);
+}
+
+
+int main()
+{
+    int failed = 0;
+
+    failed += testPow2WrapAndCapacity();
+    failed += testOverflowPolicies();
+    failed += testWatermarkAndStats();
+    failed += testPeekAtAndCopyLast();
+    failed += testConvertFloat();
+    failed += testResize();
+    failed += testSpscBlockingFullAndEmpty();
+    failed += testSpscShrinkWithParkedProducer();
+    failed += testRecordShortCommitAtWrap();
+    failed += testMpmcContention();
+    failed += testBroadcastFullAndWrap();
+    failed += testPersistCrashAfterWrap();
+    failed += testShmPeerIndexOutOfRange();
+
+    return failed;
+}
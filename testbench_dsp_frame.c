@@ -2,6 +2,7 @@
 #include <stdlib.h>
 #include "dsp_frame.h"
 #include "circularBuffer.h"
+#include "dsp_frame_multichannel.h"
 
 #define     RING_LENGTH         8
 #define     FRAME_SIZE          4
@@ -18,10 +19,72 @@ _RING_BUFFER_DATA_TYPE      p_myBuffer_2[RING_LENGTH];
 _RING_BUFFER_DATA_TYPE      p_myFrame_2;
 _RING_BUFFER_DATA_TYPE      userInput;
 
+/* Multichannel check : sample frames per buffer, frame and overlap (samples per channel), largest channel count */
+#define     MC_RING_FRAMES      10
+#define     MC_FRAME_SIZE       9
+#define     MC_OVERLAP_LENGTH   3
+#define     MC_MAX_CHANNELS     8
+
+static int32_t multichannelSample(uint32_t t, uint32_t c)
+{
+    return (int32_t)(t*100 + c) - 500;
+}
+
+/**
+  * Extract planar frames of 2, 3, 4 and 8 channels, fed 3 sample frames at a time. Frames start at sample frame 0, 6, 2, 8, 4
+  * of the buffer, so the wrap splits them as 9, 4+5, 8+1, 2+7 and 6+3 sample frames : each split goes through the 2-channel
+  * or 4x4 shuffles (SSE2/NEON) and the scalar tail. Every planar row must hold the samples of its channel in order.
+  * @retval 0 -> pass, 1 -> fail
+  */
+static int checkMultichannelWrap(void)
+{
+    static const uint32_t           channelList[] = {2, 3, 4, 8};
+    circularBuffer_TypeDef          mcBuffer;
+    dspFrameMultichannel_TypeDef    mcFrame;
+    int32_t                         mcStorage[MC_RING_FRAMES*MC_MAX_CHANNELS];
+    int32_t                         mcPlanar[MC_FRAME_SIZE*MC_MAX_CHANNELS];
+    int32_t                         input[3*MC_MAX_CHANNELS];
+    uint32_t                        k, t, c, i, channels, pushed, frames;
+    int                             failed = 0;
+
+    for(k=0; k<sizeof(channelList)/sizeof(channelList[0]); k++)
+    {
+        channels = channelList[k];
+        DSP_multichannel_InitBuffer(&mcBuffer, mcStorage, channels, MC_RING_FRAMES);
+        DSP_multichannel_InitFrame(&mcFrame, mcPlanar, channels, MC_FRAME_SIZE, MC_OVERLAP_LENGTH);
+
+        for(pushed=0, frames=0; pushed<60; pushed+=3)
+        {
+            for(t=0; t<3; t++)
+            {
+                for(c=0; c<channels; c++)   input[t*channels + c] = multichannelSample(pushed + t, c);
+            }
+            if(DSP_multichannel_Enqueue(&mcBuffer, channels, input, 3) != 3)       failed = 1;
+
+            while(DSP_multichannel_GetNextFrame(&mcBuffer, &mcFrame) == FRAME_IS_READY)
+            {
+                for(c=0; c<channels; c++)
+                {
+                    for(i=0; i<MC_FRAME_SIZE; i++)
+                    {
+                        t = frames*(MC_FRAME_SIZE - MC_OVERLAP_LENGTH) + i;
+                        if(mcPlanar[c*MC_FRAME_SIZE + i] != multichannelSample(t, c))   failed = 1;
+                    }
+                }
+                frames++;
+            }
+        }
+        if(frames != (60 - MC_FRAME_SIZE)/(MC_FRAME_SIZE - MC_OVERLAP_LENGTH) + 1)     failed = 1;
+    }
+    return failed;
+}
+
 int main()
 {
     int i=0;
 
+    printf("multichannel deinterleave across wrap : %s\n\n", checkMultichannelWrap() ? "FAIL" : "PASS");
+
     CircularBuffer_Init (&myRingBuffer_1,
                          p_myBuffer_1,
                          sizeof(_RING_BUFFER_DATA_TYPE),